@@ -0,0 +1,274 @@
+package com.reactcardconnect.sdk;
+
+import android.util.Log;
+
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.WritableArray;
+import com.facebook.react.bridge.WritableMap;
+
+import org.json.JSONException;
+import org.json.JSONObject;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.charset.Charset;
+import java.util.Arrays;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Executors;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * Audit trail of tokenization results written as NDJSON segments. record
+ * claims a slot in a lock-free ring and returns; a single writer thread
+ * drains the ring, rotates segments at maxSegmentBytes and keeps the newest
+ * maxSegments. A full ring drops the new record and counts it instead of
+ * blocking the caller. Same layout and file format as the iOS writer.
+ */
+class AuditLog {
+
+    enum Sync { NEVER, SEGMENT, BATCH }
+
+    private static final String TAG = "CardConnectAudit";
+    private static final int CAPACITY = 1024;
+    private static final int KICK_INTERVAL = 256;
+    private static final long DRAIN_INTERVAL_MS = 1000;
+    private static final Charset UTF_8 = Charset.forName("UTF-8");
+
+    private static final class Record {
+        final long time;
+        final String maskedCardNumber;
+        final String token;
+        final String issuer;
+        final String code;
+        final double latency;
+
+        Record(long time, String maskedCardNumber, String token, String issuer, String code, double latency) {
+            this.time = time;
+            this.maskedCardNumber = maskedCardNumber;
+            this.token = token;
+            this.issuer = issuer;
+            this.code = code;
+            this.latency = latency;
+        }
+    }
+
+    // Per-slot sequence numbers: equal to the position while the slot is free
+    // for it, position + 1 once it holds that position's record.
+    private final AtomicLongArray mSequences = new AtomicLongArray(CAPACITY);
+    private final Record[] mSlots = new Record[CAPACITY];
+    private final AtomicLong mEnqueuePosition = new AtomicLong();
+    private final AtomicLong mRecorded = new AtomicLong();
+    private final AtomicLong mDropped = new AtomicLong();
+    private final AtomicBoolean mKicked = new AtomicBoolean();
+
+    private final File mDirectory;
+    private final long mMaxSegmentBytes;
+    private final int mMaxSegments;
+    private final Sync mSync;
+    private final ScheduledExecutorService mWriter = Executors.newSingleThreadScheduledExecutor();
+
+    // Writer thread only.
+    private long mDequeuePosition;
+    private FileOutputStream mSegment;
+    private long mSegmentBytes;
+    private long mWritten;
+
+    private final Runnable mDrain = new Runnable() {
+        @Override
+        public void run() {
+            mKicked.set(false);
+            drain();
+        }
+    };
+
+    AuditLog(File directory, long maxSegmentBytes, int maxSegments, Sync sync) {
+        for (int i = 0; i < CAPACITY; i++) {
+            mSequences.set(i, i);
+        }
+        mDirectory = directory;
+        mMaxSegmentBytes = Math.max(maxSegmentBytes, 1024);
+        mMaxSegments = Math.max(maxSegments, 1);
+        mSync = sync;
+        mDirectory.mkdirs();
+        mWriter.scheduleWithFixedDelay(mDrain, DRAIN_INTERVAL_MS, DRAIN_INTERVAL_MS, TimeUnit.MILLISECONDS);
+    }
+
+    /**
+     * Safe to call from any thread. Pass a negative latency when unknown.
+     */
+    void record(String maskedCardNumber, String token, String issuer, String code, double latency) {
+        long position = mEnqueuePosition.get();
+        int index;
+        while (true) {
+            index = (int) (position & (CAPACITY - 1));
+            long difference = mSequences.get(index) - position;
+            if (difference == 0) {
+                if (mEnqueuePosition.compareAndSet(position, position + 1)) {
+                    break;
+                }
+                position = mEnqueuePosition.get();
+            } else if (difference < 0) {
+                // The writer is a full lap behind.
+                mDropped.incrementAndGet();
+                kick();
+                return;
+            } else {
+                position = mEnqueuePosition.get();
+            }
+        }
+
+        mSlots[index] = new Record(System.currentTimeMillis(), maskedCardNumber, token, issuer, code, latency);
+        mSequences.set(index, position + 1);
+        mRecorded.incrementAndGet();
+        if ((position + 1) % KICK_INTERVAL == 0) {
+            kick();
+        }
+    }
+
+    /**
+     * Drains what is buffered, closes the current segment and stops the writer.
+     */
+    void close() {
+        mWriter.execute(new Runnable() {
+            @Override
+            public void run() {
+                drain();
+                closeSegment();
+            }
+        });
+        mWriter.shutdown();
+    }
+
+    WritableMap stats() {
+        WritableMap stats = Arguments.createMap();
+        stats.putDouble("recorded", mRecorded.get());
+        stats.putDouble("dropped", mDropped.get());
+        try {
+            Object[] state = mWriter.submit(new Callable<Object[]>() {
+                @Override
+                public Object[] call() {
+                    return new Object[] {mWritten, segmentFiles()};
+                }
+            }).get();
+            stats.putDouble("written", (Long) state[0]);
+            WritableArray files = Arguments.createArray();
+            for (File file : (File[]) state[1]) {
+                files.pushString(file.getAbsolutePath());
+            }
+            stats.putArray("files", files);
+        } catch (InterruptedException | ExecutionException | RejectedExecutionException e) {
+            // Closed; only the counters are meaningful.
+        }
+        return stats;
+    }
+
+    private void kick() {
+        if (mKicked.compareAndSet(false, true)) {
+            try {
+                mWriter.execute(mDrain);
+            } catch (RejectedExecutionException e) {
+                // Closed.
+            }
+        }
+    }
+
+    private void drain() {
+        StringBuilder batch = new StringBuilder();
+        int count = 0;
+        while (true) {
+            int index = (int) (mDequeuePosition & (CAPACITY - 1));
+            if (mSequences.get(index) != mDequeuePosition + 1) {
+                break;
+            }
+            Record record = mSlots[index];
+            mSlots[index] = null;
+            mSequences.set(index, mDequeuePosition + CAPACITY);
+            mDequeuePosition++;
+
+            try {
+                JSONObject line = new JSONObject();
+                line.put("time", record.time / 1000.0);
+                line.put("kind", "token");
+                line.put("maskedCardNumber", record.maskedCardNumber != null ? record.maskedCardNumber : JSONObject.NULL);
+                line.put("token", record.token != null ? record.token : JSONObject.NULL);
+                line.put("issuer", record.issuer != null ? record.issuer : JSONObject.NULL);
+                line.put("code", record.code != null ? record.code : JSONObject.NULL);
+                line.put("latency", record.latency >= 0 ? record.latency : JSONObject.NULL);
+                batch.append(line.toString()).append('\n');
+                count++;
+            } catch (JSONException e) {
+                Log.w(TAG, "Skipping audit record", e);
+            }
+        }
+        if (count == 0) {
+            return;
+        }
+
+        try {
+            if (mSegment == null || mSegmentBytes >= mMaxSegmentBytes) {
+                closeSegment();
+                openSegment();
+            }
+            byte[] bytes = batch.toString().getBytes(UTF_8);
+            mSegment.write(bytes);
+            mSegmentBytes += bytes.length;
+            mWritten += count;
+            if (mSync == Sync.BATCH) {
+                mSegment.getFD().sync();
+            }
+        } catch (IOException e) {
+            Log.w(TAG, "Failed to write audit records", e);
+        }
+    }
+
+    private void openSegment() throws IOException {
+        File file = new File(mDirectory, "audit-" + System.currentTimeMillis() + ".ndjson");
+        mSegment = new FileOutputStream(file, true);
+        mSegmentBytes = file.length();
+
+        File[] files = segmentFiles();
+        for (int i = 0; i < files.length - mMaxSegments; i++) {
+            files[i].delete();
+        }
+    }
+
+    private void closeSegment() {
+        if (mSegment == null) {
+            return;
+        }
+        try {
+            if (mSync != Sync.NEVER) {
+                mSegment.getFD().sync();
+            }
+            mSegment.close();
+        } catch (IOException e) {
+            Log.w(TAG, "Failed to close audit segment", e);
+        }
+        mSegment = null;
+    }
+
+    /** Oldest first; the names sort by creation time. */
+    private File[] segmentFiles() {
+        File[] files = mDirectory.listFiles();
+        if (files == null) {
+            return new File[0];
+        }
+        int count = 0;
+        for (File file : files) {
+            String name = file.getName();
+            if (name.startsWith("audit-") && name.endsWith(".ndjson")) {
+                files[count++] = file;
+            }
+        }
+        File[] segments = Arrays.copyOf(files, count);
+        Arrays.sort(segments);
+        return segments;
+    }
+}
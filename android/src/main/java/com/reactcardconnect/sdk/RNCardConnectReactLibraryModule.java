@@ -1,23 +1,166 @@
 
 package com.reactcardconnect.sdk;
 
+import android.os.SystemClock;
+import android.util.Log;
+
 import com.cardconnect.consumersdk.CCConsumer;
 import com.cardconnect.consumersdk.CCConsumerTokenCallback;
 import com.cardconnect.consumersdk.domain.CCConsumerAccount;
 import com.cardconnect.consumersdk.domain.CCConsumerCardInfo;
 import com.cardconnect.consumersdk.domain.CCConsumerError;
+import com.cardconnect.consumersdk.enums.CCConsumerCardIssuer;
+import com.cardconnect.consumersdk.network.CCConsumerApi;
 import com.cardconnect.consumersdk.utils.CCConsumerCardUtils;
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.LifecycleEventListener;
 import com.facebook.react.bridge.Promise;
 import com.facebook.react.bridge.ReactApplicationContext;
 import com.facebook.react.bridge.ReactContextBaseJavaModule;
 import com.facebook.react.bridge.ReactMethod;
+import com.facebook.react.bridge.ReadableArray;
 import com.facebook.react.bridge.ReadableMap;
+import com.facebook.react.bridge.WritableArray;
+import com.facebook.react.bridge.WritableMap;
+import com.facebook.react.modules.core.DeviceEventManagerModule;
+
+import org.json.JSONException;
+import org.json.JSONObject;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStreamWriter;
+import java.io.Writer;
+import java.util.ArrayList;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Set;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicInteger;
+
+
+public class RNCardConnectReactLibraryModule extends ReactContextBaseJavaModule implements LifecycleEventListener {
+
+    private static final String TAG = "CardConnect";
+
+    static final String E_INVALID_CARD_NUMBER = "E_INVALID_CARD_NUMBER";
+    static final String E_INVALID_CVV = "E_INVALID_CVV";
+    static final String E_CANCELLED = "E_CANCELLED";
+    static final String E_QUEUE_FULL = "E_QUEUE_FULL";
+
+    // Requests over the limiter's current concurrency wait in a queue of at
+    // most this many before new ones are shed with E_QUEUE_FULL.
+    private static final int MAX_QUEUED_REQUESTS = 256;
+    // Rows a getCardTokens batch keeps submitted at once, well inside the queue.
+    private static final int BATCH_WINDOW = 64;
+
+    private static final int VALIDATION_THREADS = Runtime.getRuntime().availableProcessors();
+    private static final ExecutorService sValidationExecutor = Executors.newFixedThreadPool(VALIDATION_THREADS);
+
+    private CCConsumerApi mConsumerApi;
+    // Only created once the app opts in with setTokenCacheEnabled.
+    private volatile TokenCache mTokenCache;
+    // Only created once the app opts in with setAuditLogEnabled.
+    private volatile AuditLog mAuditLog;
+    // The consumer API cannot abort a request, so cancelling settles the
+    // promise here and the late SDK callback is dropped.
+    private final Set<TokenCallback> mPendingRequests = new HashSet<>();
+    private final RequestLimiter mLimiter = new RequestLimiter(MAX_QUEUED_REQUESTS);
+    private final Set<TokenBatch> mBatches = new HashSet<>();
+
+    /**
+     * Where a token request settles: a promise for getCardToken, or a row of a
+     * getCardTokens batch. A null code rejects with the error alone.
+     */
+    interface TokenCallback {
+        void resolve(String token);
 
+        void reject(String code, String message, Throwable error);
+    }
+
+    private static class PromiseTokenCallback implements TokenCallback {
+        private final Promise mPromise;
+
+        PromiseTokenCallback(Promise promise) {
+            mPromise = promise;
+        }
 
-public class RNCardConnectReactLibraryModule extends ReactContextBaseJavaModule {
+        @Override
+        public void resolve(String token) {
+            mPromise.resolve(token);
+        }
+
+        @Override
+        public void reject(String code, String message, Throwable error) {
+            if (code == null) {
+                mPromise.reject(error);
+            } else {
+                mPromise.reject(code, message);
+            }
+        }
+    }
+
+    private static class TracedTokenCallback implements TokenCallback {
+        private final long mStart;
+        private final long mFlow;
+        private final TokenCallback mCallback;
+
+        TracedTokenCallback(long start, long flow, TokenCallback callback) {
+            mStart = start;
+            mFlow = flow;
+            mCallback = callback;
+        }
+
+        @Override
+        public void resolve(String token) {
+            Tracer.end("getCardToken", mStart, mFlow);
+            Tracer.instant("resolve", mFlow);
+            mCallback.resolve(token);
+        }
+
+        @Override
+        public void reject(String code, String message, Throwable error) {
+            Tracer.end("getCardToken", mStart, mFlow);
+            Tracer.instant("reject", mFlow);
+            mCallback.reject(code, message, error);
+        }
+    }
+
+    private static class AuditedTokenCallback implements TokenCallback {
+        private final AuditLog mAuditLog;
+        private final String mMaskedCardNumber;
+        private final String mIssuer;
+        private final long mStart = SystemClock.elapsedRealtime();
+        private final TokenCallback mCallback;
+
+        AuditedTokenCallback(AuditLog auditLog, String cardNumber, TokenCallback callback) {
+            mAuditLog = auditLog;
+            mMaskedCardNumber = maskCardNumber(cardNumber);
+            CCConsumerCardIssuer issuer = cardNumber != null && !cardNumber.isEmpty()
+                ? CCConsumerCardUtils.getIssuerFromCardNumber(cardNumber)
+                : null;
+            mIssuer = issuer != null ? issuer.toString() : null;
+            mCallback = callback;
+        }
+
+        @Override
+        public void resolve(String token) {
+            mAuditLog.record(mMaskedCardNumber, token, mIssuer, null, SystemClock.elapsedRealtime() - mStart);
+            mCallback.resolve(token);
+        }
+
+        @Override
+        public void reject(String code, String message, Throwable error) {
+            mAuditLog.record(mMaskedCardNumber, null, mIssuer, code != null ? code : "error", SystemClock.elapsedRealtime() - mStart);
+            mCallback.reject(code, message, error);
+        }
+    }
 
     public RNCardConnectReactLibraryModule(ReactApplicationContext reactContext) {
         super(reactContext);
+        reactContext.addLifecycleEventListener(this);
     }
 
     @Override
@@ -25,6 +168,56 @@ public class RNCardConnectReactLibraryModule extends ReactContextBaseJavaModule
         return "CardConnect";
     }
 
+    @ReactMethod
+    public void prepare(ReadableMap options, final Promise promise) {
+        final long start = SystemClock.elapsedRealtime();
+        final WritableMap steps = Arguments.createMap();
+        final Runnable[] work = new Runnable[] {
+            new Runnable() {
+                @Override
+                public void run() {
+                    long stepStart = SystemClock.elapsedRealtime();
+                    getConsumerApi();
+                    recordStep(steps, "api", stepStart);
+                }
+            },
+            new Runnable() {
+                @Override
+                public void run() {
+                    // Compiles the issuer patterns inside CCConsumerCardUtils.
+                    long stepStart = SystemClock.elapsedRealtime();
+                    validateCard("4111111111111111", "123");
+                    recordStep(steps, "cardUtils", stepStart);
+                }
+            },
+        };
+
+        final AtomicInteger remaining = new AtomicInteger(work.length);
+        for (final Runnable step : work) {
+            sValidationExecutor.execute(new Runnable() {
+                @Override
+                public void run() {
+                    step.run();
+                    if (remaining.decrementAndGet() == 0) {
+                        WritableMap result = Arguments.createMap();
+                        synchronized (steps) {
+                            result.putMap("steps", steps);
+                        }
+                        result.putDouble("total", SystemClock.elapsedRealtime() - start);
+                        promise.resolve(result);
+                    }
+                }
+            });
+        }
+    }
+
+    private static void recordStep(WritableMap steps, String name, long start) {
+        long elapsed = SystemClock.elapsedRealtime() - start;
+        synchronized (steps) {
+            steps.putDouble(name, elapsed);
+        }
+    }
+
     @ReactMethod
     public void getCardToken(
       String cardNumber,
@@ -32,65 +225,488 @@ public class RNCardConnectReactLibraryModule extends ReactContextBaseJavaModule
       String cvv,
       final Promise promise
     ) {
-        // String cardNumber = options.getString("cardNumber");
-        // String cvv = options.getString("cvv");
-        // String expiryDate = options.getString("expiryDate");
+        requestToken(cardNumber, expiryDate, cvv, RequestLimiter.Priority.INTERACTIVE, new PromiseTokenCallback(promise));
+    }
 
-        try {
-            validateCardNumber(cardNumber);
-            validateCvv(cvv);
+    @ReactMethod
+    public void getCardTokenWithOptions(
+      String cardNumber,
+      String expiryDate,
+      String cvv,
+      ReadableMap options,
+      final Promise promise
+    ) {
+        RequestLimiter.Priority priority = options != null && options.hasKey("priority")
+            && "background".equals(options.getString("priority"))
+            ? RequestLimiter.Priority.BACKGROUND
+            : RequestLimiter.Priority.INTERACTIVE;
+        requestToken(cardNumber, expiryDate, cvv, priority, new PromiseTokenCallback(promise));
+    }
+
+    private void requestToken(
+      String cardNumber,
+      String expiryDate,
+      String cvv,
+      RequestLimiter.Priority priority,
+      TokenCallback requestCallback
+    ) {
+        final long traceStart = Tracer.begin();
+        final long flow = traceStart != 0 ? Tracer.nextFlow() : 0;
+        if (traceStart != 0) {
+            requestCallback = new TracedTokenCallback(traceStart, flow, requestCallback);
+        }
+
+        AuditLog auditLog = mAuditLog;
+        final TokenCallback callback = auditLog != null
+            ? new AuditedTokenCallback(auditLog, cardNumber, requestCallback)
+            : requestCallback;
 
-            CCConsumerCardInfo mCCConsumerCardInfo = new CCConsumerCardInfo();
-            mCCConsumerCardInfo.setCardNumber(cardNumber);
-            mCCConsumerCardInfo.setExpirationDate(expiryDate);
-            mCCConsumerCardInfo.setCvv(cvv);
+        String error = validateCard(cardNumber, cvv);
+        if (error != null) {
+            callback.reject(error, errorMessage(error), null);
+            return;
+        }
+
+        final TokenCache tokenCache = mTokenCache;
+        final String cacheKey = tokenCache != null ? tokenCache.keyFor(cardNumber, expiryDate, cvv) : null;
+        String cachedToken = tokenCache != null ? tokenCache.get(cacheKey) : null;
+        if (cachedToken != null) {
+            callback.resolve(cachedToken);
+            return;
+        }
 
-            CCConsumer.getInstance().getApi().generateAccountForCard(mCCConsumerCardInfo, new CCConsumerTokenCallback() {
+        final CCConsumerCardInfo mCCConsumerCardInfo = new CCConsumerCardInfo();
+        mCCConsumerCardInfo.setCardNumber(cardNumber);
+        mCCConsumerCardInfo.setExpirationDate(expiryDate);
+        mCCConsumerCardInfo.setCvv(cvv);
+
+        addPendingRequest(callback);
+        boolean accepted = mLimiter.enqueue(new RequestLimiter.Operation() {
+            @Override
+            public void start(RequestLimiter.Done done) {
+                Tracer.end("limiterWait", traceStart, flow);
+                generateToken(mCCConsumerCardInfo, flow, tokenCache, cacheKey, callback, done);
+            }
+
+            @Override
+            public void cancel() {
+                clearCardInfo(mCCConsumerCardInfo);
+                if (removePendingRequest(callback)) {
+                    callback.reject(E_CANCELLED, "Request cancelled", null);
+                }
+            }
+        }, priority);
+        if (!accepted) {
+            clearCardInfo(mCCConsumerCardInfo);
+            if (removePendingRequest(callback)) {
+                callback.reject(E_QUEUE_FULL, "Too many tokenization requests pending", null);
+            }
+        }
+    }
+
+    private void generateToken(
+      final CCConsumerCardInfo mCCConsumerCardInfo,
+      final long flow,
+      final TokenCache tokenCache,
+      final String cacheKey,
+      final TokenCallback callback,
+      final RequestLimiter.Done done
+    ) {
+        final long networkStart = Tracer.begin();
+        try {
+            getConsumerApi().generateAccountForCard(mCCConsumerCardInfo, new CCConsumerTokenCallback() {
                 @Override
                 public void onCCConsumerTokenResponseError(CCConsumerError ccConsumerError) {
-                    promise.reject(new Exception(ccConsumerError.getResponseMessage()));
+                    Tracer.end("network", networkStart, flow);
+                    // A request cancelPendingRequests already settled is
+                    // dropped, so it does not shrink the limiter's window.
+                    boolean pending = removePendingRequest(callback);
+                    done.finish(pending ? RequestLimiter.Outcome.FAILURE : RequestLimiter.Outcome.DROPPED);
+                    clearCardInfo(mCCConsumerCardInfo);
+                    if (pending) {
+                        callback.reject(null, null, new Exception(ccConsumerError.getResponseMessage()));
+                    }
                 }
 
                 @Override
                 public void onCCConsumerTokenResponse(CCConsumerAccount ccConsumerAccount) {
-                    promise.resolve(ccConsumerAccount.getToken());
+                    Tracer.end("network", networkStart, flow);
+                    boolean pending = removePendingRequest(callback);
+                    done.finish(pending ? RequestLimiter.Outcome.SUCCESS : RequestLimiter.Outcome.DROPPED);
+                    clearCardInfo(mCCConsumerCardInfo);
+                    if (tokenCache != null) {
+                        tokenCache.put(cacheKey, ccConsumerAccount.getToken());
+                    }
+                    if (pending) {
+                        callback.resolve(ccConsumerAccount.getToken());
+                    }
                 }
             });
-        } catch (ValidateException e) {
-            promise.reject(e);
-        }catch (Exception e){
-            promise.resolve(e);
-            e.printStackTrace();
+        } catch (Exception e) {
+            boolean pending = removePendingRequest(callback);
+            done.finish(RequestLimiter.Outcome.DROPPED);
+            clearCardInfo(mCCConsumerCardInfo);
+            if (pending) {
+                callback.reject(null, null, e);
+            } else {
+                Log.w(TAG, "Tokenization failed after the request was cancelled", e);
+            }
+        }
+    }
+
+    @ReactMethod
+    public void getCardTokens(final ReadableArray cards, ReadableMap options, final Promise promise) {
+        final String batchId = options != null && options.hasKey("batchId") ? options.getString("batchId") : null;
+        int requestedStart = options != null && options.hasKey("startIndex") ? options.getInt("startIndex") : 0;
+        final int count = cards.size();
+        int startIndex = Math.max(0, Math.min(requestedStart, count));
+        final RequestLimiter.Priority priority = options != null && options.hasKey("priority")
+            && "interactive".equals(options.getString("priority"))
+            ? RequestLimiter.Priority.INTERACTIVE
+            : RequestLimiter.Priority.BACKGROUND;
+
+        final TokenBatch[] batch = new TokenBatch[1];
+        batch[0] = new TokenBatch(startIndex, count, BATCH_WINDOW, new TokenBatch.Submitter() {
+            @Override
+            public void submit(final int index, final TokenBatch.RowDone done) {
+                // Rows after the first window are submitted from SDK callback
+                // and limiter threads; the bridge array and request setup are
+                // only touched on the native modules thread, like bridge calls.
+                getReactApplicationContext().runOnNativeModulesQueueThread(new Runnable() {
+                    @Override
+                    public void run() {
+                        // cancelPendingRequests may have run while this row was waiting.
+                        if (batch[0].isStopped()) {
+                            done.finish(null);
+                            return;
+                        }
+                        ReadableMap card = cards.getMap(index);
+                        String cardNumber = card.hasKey("cardNumber") ? card.getString("cardNumber") : null;
+                        final WritableMap result = Arguments.createMap();
+                        result.putString("maskedCardNumber", maskCardNumber(cardNumber));
+                        if (cardNumber != null && !cardNumber.isEmpty()) {
+                            CCConsumerCardIssuer issuer = CCConsumerCardUtils.getIssuerFromCardNumber(cardNumber);
+                            result.putString("issuer", issuer != null ? issuer.toString() : null);
+                        }
+
+                        requestToken(
+                            cardNumber,
+                            card.hasKey("expiryDate") ? card.getString("expiryDate") : null,
+                            card.hasKey("cvv") ? card.getString("cvv") : null,
+                            priority,
+                            new TokenCallback() {
+                                @Override
+                                public void resolve(String token) {
+                                    result.putString("token", token);
+                                    done.finish(result);
+                                }
+
+                                @Override
+                                public void reject(String code, String message, Throwable error) {
+                                    if (E_CANCELLED.equals(code)) {
+                                        done.finish(null);
+                                        return;
+                                    }
+                                    result.putString("code", code != null ? code : "error");
+                                    result.putString("message", code != null ? message : error.getMessage());
+                                    done.finish(result);
+                                }
+                            });
+                    }
+                });
+            }
+        }, new TokenBatch.Listener() {
+            @Override
+            public void onRowFinished(int index, WritableMap result, int checkpoint) {
+                result.putString("batchId", batchId);
+                result.putInt("index", index);
+                result.putInt("checkpoint", checkpoint);
+                getReactApplicationContext()
+                    .getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter.class)
+                    .emit("tokenizationResult", result);
+            }
+
+            @Override
+            public void onComplete(int succeeded, int failed, int checkpoint) {
+                synchronized (mBatches) {
+                    mBatches.remove(batch[0]);
+                }
+                WritableMap summary = Arguments.createMap();
+                summary.putInt("succeeded", succeeded);
+                summary.putInt("failed", failed);
+                summary.putInt("checkpoint", checkpoint);
+                summary.putBoolean("complete", checkpoint == count);
+                promise.resolve(summary);
+            }
+        });
+
+        synchronized (mBatches) {
+            mBatches.add(batch[0]);
         }
+        batch[0].run();
     }
 
-    private void validateCardNumber(String cardNumber) throws ValidateException {
-        if (!CCConsumerCardUtils.validateCardNumber(cardNumber)) {
-            throw new ValidateException("Invalid CardNumber");
+    @ReactMethod
+    public void setTokenCacheEnabled(boolean enabled, double ttl) {
+        if (!enabled) {
+            clearTokenCache();
+            mTokenCache = null;
+            return;
+        }
+        TokenCache tokenCache = mTokenCache;
+        if (tokenCache == null) {
+            tokenCache = new TokenCache();
+            mTokenCache = tokenCache;
         }
+        tokenCache.setTtlMillis((long) (ttl * 1000));
     }
 
-    private void validateCvv(String cvv) throws ValidateException {
-        if (!CCConsumerCardUtils.validateCvvNumber(cvv)) {
-            throw new ValidateException("Invalid CVV");
+    @ReactMethod
+    public void clearTokenCache() {
+        TokenCache tokenCache = mTokenCache;
+        if (tokenCache != null) {
+            tokenCache.clear();
         }
     }
 
-    private void validateExpiryDate(String expiryDate) throws ValidateException {
+    @Override
+    public void onHostResume() {
+    }
+
+    @Override
+    public void onHostPause() {
+        // Cached tokens only live for the foreground checkout session.
+        clearTokenCache();
+    }
+
+    @Override
+    public void onHostDestroy() {
+        clearTokenCache();
+        AuditLog auditLog = mAuditLog;
+        mAuditLog = null;
+        if (auditLog != null) {
+            auditLog.close();
+        }
+    }
+
+    @ReactMethod
+    public void validateCards(ReadableArray cards, final Promise promise) {
+        final int count = cards.size();
+        final String[] cardNumbers = new String[count];
+        final String[] cvvs = new String[count];
+        for (int i = 0; i < count; i++) {
+            ReadableMap card = cards.getMap(i);
+            cardNumbers[i] = card.hasKey("cardNumber") ? card.getString("cardNumber") : null;
+            cvvs[i] = card.hasKey("cvv") ? card.getString("cvv") : null;
+        }
+
+        final WritableMap[] results = new WritableMap[count];
+        int chunks = Math.max(1, Math.min(VALIDATION_THREADS, count));
+        int chunkSize = (count + chunks - 1) / chunks;
+        final AtomicInteger remaining = new AtomicInteger(chunks);
+
+        // One contiguous slice per worker; whichever worker finishes last
+        // builds the result so the module thread never blocks.
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            final int start = chunk * chunkSize;
+            final int end = Math.min(count, start + chunkSize);
+            sValidationExecutor.execute(new Runnable() {
+                @Override
+                public void run() {
+                    for (int i = start; i < end; i++) {
+                        results[i] = checkCard(cardNumbers[i], cvvs[i]);
+                    }
+                    if (remaining.decrementAndGet() == 0) {
+                        WritableArray array = Arguments.createArray();
+                        for (WritableMap result : results) {
+                            array.pushMap(result);
+                        }
+                        promise.resolve(array);
+                    }
+                }
+            });
+        }
+    }
+
+    /**
+     * Reports every SDK check for one card separately so the two platforms'
+     * validators can be compared case by case.
+     */
+    private static WritableMap checkCard(String cardNumber, String cvv) {
+        boolean present = cardNumber != null && !cardNumber.isEmpty();
+        CCConsumerCardIssuer issuer = present ? CCConsumerCardUtils.getIssuerFromCardNumber(cardNumber) : null;
+        boolean lengthValid = present && CCConsumerCardUtils.validateCardLength(cardNumber);
+        String code = validateCard(cardNumber, cvv);
+
+        WritableMap result = Arguments.createMap();
+        result.putBoolean("valid", code == null);
+        result.putString("code", code);
+        result.putString("issuer", issuer != null ? issuer.toString() : null);
+        result.putBoolean("lengthValid", lengthValid);
+        result.putBoolean("cardNumberValid", present && CCConsumerCardUtils.validateCardNumber(cardNumber));
+        result.putBoolean("cvvValid", cvv != null && CCConsumerCardUtils.validateCvvNumber(cvv));
+        return result;
+    }
+
+    @ReactMethod
+    public void setAuditLogEnabled(boolean enabled, ReadableMap options) {
+        AuditLog previous = mAuditLog;
+        mAuditLog = null;
+        if (previous != null) {
+            previous.close();
+        }
+        if (!enabled) {
+            return;
+        }
+
+        File directory = options != null && options.hasKey("directory")
+            ? new File(options.getString("directory"))
+            : new File(getReactApplicationContext().getFilesDir(), "RNCardConnectAudit");
+        long maxSegmentBytes = options != null && options.hasKey("maxSegmentBytes") ? (long) options.getDouble("maxSegmentBytes") : 1024 * 1024;
+        int maxSegments = options != null && options.hasKey("maxSegments") ? options.getInt("maxSegments") : 8;
+        String sync = options != null && options.hasKey("sync") ? options.getString("sync") : null;
+        mAuditLog = new AuditLog(
+            directory,
+            maxSegmentBytes,
+            maxSegments,
+            "batch".equals(sync) ? AuditLog.Sync.BATCH : "never".equals(sync) ? AuditLog.Sync.NEVER : AuditLog.Sync.SEGMENT);
+    }
+
+    @ReactMethod
+    public void getAuditLogStats(Promise promise) {
+        AuditLog auditLog = mAuditLog;
+        promise.resolve(auditLog != null ? auditLog.stats() : null);
+    }
+
+    @ReactMethod
+    public void setTracingEnabled(boolean enabled) {
+        Tracer.setEnabled(enabled);
+    }
+
+    @ReactMethod
+    public void exportTrace(Promise promise) {
+        int[] dropped = new int[1];
+        File file = new File(getReactApplicationContext().getCacheDir(), "cardconnect-trace-" + System.currentTimeMillis() + ".json");
         try {
-            String[] array = expiryDate.split("/");
-            if (!CCConsumerCardUtils.validateExpirationDate(array[0], array[1])) {
-                throw new ValidateException("Invalid ExpiryDate");
+            JSONObject trace = Tracer.export(dropped);
+            Writer writer = new OutputStreamWriter(new FileOutputStream(file), "UTF-8");
+            try {
+                writer.write(trace.toString());
+            } finally {
+                writer.close();
             }
-        } catch (Exception e) {
-            throw new ValidateException("Invalid ExpiryDate");
+
+            WritableMap result = Arguments.createMap();
+            result.putString("path", file.getAbsolutePath());
+            result.putInt("events", trace.getJSONArray("traceEvents").length());
+            result.putInt("dropped", dropped[0]);
+            promise.resolve(result);
+        } catch (JSONException | IOException e) {
+            promise.reject(e);
+        }
+    }
+
+    @ReactMethod
+    public void getRequestStats(Promise promise) {
+        promise.resolve(mLimiter.stats());
+    }
+
+    @ReactMethod
+    public void cancelPendingRequests() {
+        List<TokenBatch> batches;
+        synchronized (mBatches) {
+            batches = new ArrayList<>(mBatches);
+        }
+        for (TokenBatch batch : batches) {
+            batch.stop();
+        }
+        mLimiter.cancelQueued();
+        List<TokenCallback> cancelled;
+        synchronized (mPendingRequests) {
+            cancelled = new ArrayList<>(mPendingRequests);
+            mPendingRequests.clear();
+        }
+        for (TokenCallback callback : cancelled) {
+            callback.reject(E_CANCELLED, "Request cancelled", null);
         }
+    }
+
+    private void addPendingRequest(TokenCallback callback) {
+        synchronized (mPendingRequests) {
+            mPendingRequests.add(callback);
+        }
+    }
 
+    /**
+     * Returns false when the request was already settled by cancelPendingRequests.
+     */
+    private boolean removePendingRequest(TokenCallback callback) {
+        synchronized (mPendingRequests) {
+            return mPendingRequests.remove(callback);
+        }
+    }
+
+    // Packages build every native module while the React instance starts, so
+    // the consumer SDK is only touched once a method actually needs it.
+    private synchronized CCConsumerApi getConsumerApi() {
+        if (mConsumerApi == null) {
+            mConsumerApi = CCConsumer.getInstance().getApi();
+        }
+        return mConsumerApi;
+    }
+
+    // Called from the token callbacks; the card info otherwise keeps the PAN
+    // and CVV reachable until the SDK lets go of it.
+    private void clearCardInfo(CCConsumerCardInfo cardInfo) {
+        cardInfo.setCardNumber("");
+        cardInfo.setCvv("");
+    }
+
+    /**
+     * Returns the status code of the first failed check, or null when the card passes.
+     */
+    private static String validateCard(String cardNumber, String cvv) {
+        if (cardNumber == null || !CCConsumerCardUtils.validateCardNumber(cardNumber)) {
+            return E_INVALID_CARD_NUMBER;
+        }
+        if (cvv == null || !CCConsumerCardUtils.validateCvvNumber(cvv)) {
+            return E_INVALID_CVV;
+        }
+        return null;
+    }
+
+    /**
+     * BIN and last four with the rest masked, or null for anything shorter
+     * than a card number.
+     */
+    private static String maskCardNumber(String cardNumber) {
+        if (cardNumber == null || cardNumber.length() < 12) {
+            return null;
+        }
+        int length = cardNumber.length();
+        StringBuilder masked = new StringBuilder(length);
+        masked.append(cardNumber, 0, 6);
+        for (int i = 6; i < length - 4; i++) {
+            masked.append('*');
+        }
+        masked.append(cardNumber, length - 4, length);
+        return masked.toString();
+    }
+
+    private static String errorMessage(String code) {
+        switch (code) {
+            case E_INVALID_CARD_NUMBER:
+                return "Invalid CardNumber";
+            case E_INVALID_CVV:
+                return "Invalid CVV";
+            default:
+                return "Invalid card data";
+        }
     }
 
     @ReactMethod
     private void setupConsumerApiEndpoint(String url) {
-        CCConsumer.getInstance().getApi().setEndPoint( "https://" + url + "/cardsecure/cs");
-        CCConsumer.getInstance().getApi().setDebugEnabled(true);
+        getConsumerApi().setEndPoint( "https://" + url + "/cardsecure/cs");
+        getConsumerApi().setDebugEnabled(true);
     }
 }
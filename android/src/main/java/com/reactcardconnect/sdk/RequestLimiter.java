@@ -0,0 +1,184 @@
+package com.reactcardconnect.sdk;
+
+import android.os.Process;
+import android.os.SystemClock;
+
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.WritableMap;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ThreadFactory;
+
+/**
+ * AIMD cap on tokenization requests in flight. Mirrors the iOS limiter: the
+ * limit creeps up while responses stay fast and halves on errors or when a
+ * response takes more than twice the best latency seen. Each priority has its
+ * own queue; freed slots go to interactive requests except every fifth, which
+ * goes to a waiting background request.
+ */
+class RequestLimiter {
+
+    enum Outcome { SUCCESS, FAILURE, DROPPED }
+
+    enum Priority { INTERACTIVE, BACKGROUND }
+
+    interface Done {
+        void finish(Outcome outcome);
+    }
+
+    interface Operation {
+        void start(Done done);
+
+        /** Called instead of start when the request is dropped from the queue. */
+        void cancel();
+    }
+
+    private static final double MIN_LIMIT = 1;
+    private static final double MAX_LIMIT = 32;
+    private static final double INITIAL_LIMIT = 4;
+    private static final int INTERACTIVE_WEIGHT = 4;
+
+    // Background requests are started from a low priority thread; interactive
+    // ones start on whichever thread freed the slot.
+    private static final ExecutorService sBackgroundExecutor = Executors.newSingleThreadExecutor(new ThreadFactory() {
+        @Override
+        public Thread newThread(final Runnable runnable) {
+            return new Thread(new Runnable() {
+                @Override
+                public void run() {
+                    Process.setThreadPriority(Process.THREAD_PRIORITY_BACKGROUND);
+                    runnable.run();
+                }
+            }, "CardConnectBackground");
+        }
+    });
+
+    private final int mMaxQueueLength;
+    private final ArrayDeque<Operation> mInteractiveQueue = new ArrayDeque<>();
+    private final ArrayDeque<Operation> mBackgroundQueue = new ArrayDeque<>();
+    private int mInteractiveStreak;
+    private int mInFlight;
+    private double mLimit = INITIAL_LIMIT;
+    private long mMinLatency;
+    private long mLastDecrease;
+
+    RequestLimiter(int maxQueueLength) {
+        mMaxQueueLength = maxQueueLength;
+    }
+
+    /**
+     * Returns false, without touching the operation, when the queue for its
+     * priority is full.
+     */
+    boolean enqueue(Operation operation, Priority priority) {
+        synchronized (this) {
+            if (mInFlight >= (int) mLimit) {
+                ArrayDeque<Operation> queue = priority == Priority.BACKGROUND ? mBackgroundQueue : mInteractiveQueue;
+                if (queue.size() >= mMaxQueueLength) {
+                    return false;
+                }
+                queue.add(operation);
+                return true;
+            }
+            mInFlight++;
+        }
+        start(operation, priority);
+        return true;
+    }
+
+    void cancelQueued() {
+        List<Operation> cancelled;
+        synchronized (this) {
+            cancelled = new ArrayList<>(mInteractiveQueue);
+            cancelled.addAll(mBackgroundQueue);
+            mInteractiveQueue.clear();
+            mBackgroundQueue.clear();
+        }
+        for (Operation operation : cancelled) {
+            operation.cancel();
+        }
+    }
+
+    synchronized WritableMap stats() {
+        WritableMap stats = Arguments.createMap();
+        stats.putInt("limit", (int) mLimit);
+        stats.putInt("inFlight", mInFlight);
+        stats.putInt("queued", mInteractiveQueue.size() + mBackgroundQueue.size());
+        stats.putInt("queuedBackground", mBackgroundQueue.size());
+        stats.putDouble("minLatency", mMinLatency);
+        return stats;
+    }
+
+    private void start(final Operation operation, Priority priority) {
+        if (priority == Priority.BACKGROUND) {
+            sBackgroundExecutor.execute(new Runnable() {
+                @Override
+                public void run() {
+                    start(operation);
+                }
+            });
+        } else {
+            start(operation);
+        }
+    }
+
+    private void start(Operation operation) {
+        final long start = SystemClock.elapsedRealtime();
+        operation.start(new Done() {
+            private boolean mFinished;
+
+            @Override
+            public void finish(Outcome outcome) {
+                synchronized (this) {
+                    if (mFinished) {
+                        return;
+                    }
+                    mFinished = true;
+                }
+                onFinished(SystemClock.elapsedRealtime() - start, outcome);
+            }
+        });
+    }
+
+    private void onFinished(long latency, Outcome outcome) {
+        List<Operation> next = new ArrayList<>();
+        List<Priority> nextPriorities = new ArrayList<>();
+        synchronized (this) {
+            mInFlight--;
+            boolean success = outcome == Outcome.SUCCESS;
+            if (success && (mMinLatency == 0 || latency < mMinLatency)) {
+                mMinLatency = latency;
+            }
+
+            long now = SystemClock.elapsedRealtime();
+            if (outcome == Outcome.DROPPED) {
+                // A cancelled request says nothing about the server.
+            } else if (!success || latency > mMinLatency * 2) {
+                // At most one decrease per observed latency, otherwise a single
+                // burst of slow responses drives the limit to the floor.
+                if (now - mLastDecrease > Math.max(latency, mMinLatency)) {
+                    mLimit = Math.max(MIN_LIMIT, mLimit / 2);
+                    mLastDecrease = now;
+                }
+            } else {
+                mLimit = Math.min(MAX_LIMIT, mLimit + 1 / mLimit);
+            }
+
+            while ((!mInteractiveQueue.isEmpty() || !mBackgroundQueue.isEmpty()) && mInFlight < (int) mLimit) {
+                boolean backgroundTurn = !mBackgroundQueue.isEmpty()
+                    && (mInteractiveQueue.isEmpty() || mInteractiveStreak >= INTERACTIVE_WEIGHT);
+                mInteractiveStreak = backgroundTurn ? 0 : mInteractiveStreak + 1;
+                next.add(backgroundTurn ? mBackgroundQueue.poll() : mInteractiveQueue.poll());
+                nextPriorities.add(backgroundTurn ? Priority.BACKGROUND : Priority.INTERACTIVE);
+                mInFlight++;
+            }
+        }
+        for (int i = 0; i < next.size(); i++) {
+            start(next.get(i), nextPriorities.get(i));
+        }
+    }
+}
@@ -0,0 +1,144 @@
+package com.reactcardconnect.sdk;
+
+import com.facebook.react.bridge.WritableMap;
+
+import java.util.BitSet;
+
+/**
+ * Feeds a range of rows through {@link Submitter} with at most {@code window}
+ * of them outstanding, so a large batch never overflows the limiter queue.
+ * Rows finish in any order; the checkpoint is the first row that has not
+ * finished, which is where an interrupted batch resumes.
+ */
+class TokenBatch {
+
+    interface RowDone {
+        /** Reports a row's result, or null when it was cancelled and should be retried on resume. */
+        void finish(WritableMap result);
+    }
+
+    interface Submitter {
+        void submit(int index, RowDone done);
+    }
+
+    interface Listener {
+        void onRowFinished(int index, WritableMap result, int checkpoint);
+
+        void onComplete(int succeeded, int failed, int checkpoint);
+    }
+
+    private final int mEnd;
+    private final int mWindow;
+    private final Submitter mSubmitter;
+    private final Listener mListener;
+
+    private int mNext;
+    private int mOutstanding;
+    private int mSucceeded;
+    private int mFailed;
+    private int mCheckpoint;
+    // Finished rows past the checkpoint, waiting for the rows before them.
+    private final BitSet mFinished = new BitSet();
+    private boolean mPumping;
+    private boolean mStopped;
+    private boolean mCompleted;
+
+    TokenBatch(int start, int end, int window, Submitter submitter, Listener listener) {
+        mNext = start;
+        mCheckpoint = start;
+        mEnd = end;
+        mWindow = Math.max(window, 1);
+        mSubmitter = submitter;
+        mListener = listener;
+    }
+
+    void run() {
+        pump();
+    }
+
+    /** Stops submitting rows; onComplete follows once the outstanding ones finish. */
+    void stop() {
+        synchronized (this) {
+            mStopped = true;
+        }
+        completeIfDone();
+    }
+
+    synchronized boolean isStopped() {
+        return mStopped;
+    }
+
+    private void pump() {
+        synchronized (this) {
+            // Rows rejected synchronously finish inside submit below; the
+            // running loop takes their slots rather than recursing per row.
+            if (mPumping) {
+                return;
+            }
+            mPumping = true;
+        }
+
+        while (true) {
+            final int index;
+            synchronized (this) {
+                if (mStopped || mNext >= mEnd || mOutstanding >= mWindow) {
+                    mPumping = false;
+                    break;
+                }
+                index = mNext++;
+                mOutstanding++;
+            }
+            mSubmitter.submit(index, new RowDone() {
+                @Override
+                public void finish(WritableMap result) {
+                    finishRow(index, result);
+                }
+            });
+        }
+        completeIfDone();
+    }
+
+    private void finishRow(int index, WritableMap result) {
+        int checkpoint;
+        synchronized (this) {
+            mOutstanding--;
+            if (result == null) {
+                mStopped = true;
+            } else {
+                if (result.hasKey("token")) {
+                    mSucceeded++;
+                } else {
+                    mFailed++;
+                }
+                mFinished.set(index);
+                while (mFinished.get(mCheckpoint)) {
+                    mFinished.clear(mCheckpoint);
+                    mCheckpoint++;
+                }
+            }
+            checkpoint = mCheckpoint;
+        }
+
+        if (result != null) {
+            mListener.onRowFinished(index, result, checkpoint);
+        }
+        pump();
+    }
+
+    private void completeIfDone() {
+        int succeeded;
+        int failed;
+        int checkpoint;
+        synchronized (this) {
+            boolean drained = mStopped || mNext >= mEnd;
+            if (mCompleted || mPumping || mOutstanding > 0 || !drained) {
+                return;
+            }
+            mCompleted = true;
+            succeeded = mSucceeded;
+            failed = mFailed;
+            checkpoint = mCheckpoint;
+        }
+        mListener.onComplete(succeeded, failed, checkpoint);
+    }
+}
@@ -0,0 +1,119 @@
+package com.reactcardconnect.sdk;
+
+import android.os.SystemClock;
+
+import java.nio.charset.Charset;
+import java.security.GeneralSecurityException;
+import java.security.SecureRandom;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Iterator;
+import java.util.Map;
+
+import javax.crypto.Mac;
+import javax.crypto.spec.SecretKeySpec;
+
+/**
+ * In-memory cache of card tokens for repeat submissions within a session.
+ * Entries are keyed by an HMAC-SHA256 of the card data under a random key that
+ * never leaves memory, so the table holds no card data. Clearing wipes the key
+ * and starts a new one.
+ */
+class TokenCache {
+
+    private static final Charset UTF_8 = Charset.forName("UTF-8");
+    private static final String ALGORITHM = "HmacSHA256";
+
+    private final SecureRandom mRandom = new SecureRandom();
+    private final byte[] mKey = new byte[32];
+    private final Map<String, Entry> mEntries = new HashMap<>();
+    private volatile long mTtlMillis;
+
+    TokenCache() {
+        mRandom.nextBytes(mKey);
+    }
+
+    void setTtlMillis(long ttlMillis) {
+        mTtlMillis = ttlMillis;
+    }
+
+    /**
+     * Returns the cache key for a card, or null if the platform has no HMAC-SHA256.
+     * Compute it up front so callers need not hold on to the card data.
+     */
+    synchronized String keyFor(String cardNumber, String expiryDate, String cvv) {
+        try {
+            Mac mac = Mac.getInstance(ALGORITHM);
+            mac.init(new SecretKeySpec(mKey, ALGORITHM));
+            // The zero byte after each field keeps ("41", "11") and ("411", "1") apart.
+            for (String field : new String[] { cardNumber, expiryDate, cvv }) {
+                if (field != null) {
+                    mac.update(field.getBytes(UTF_8));
+                }
+                mac.update((byte) 0);
+            }
+            return toHex(mac.doFinal());
+        } catch (GeneralSecurityException e) {
+            return null;
+        }
+    }
+
+    synchronized String get(String key) {
+        if (key == null) {
+            return null;
+        }
+        Entry entry = mEntries.get(key);
+        if (entry != null && entry.mExpiresAt <= SystemClock.elapsedRealtime()) {
+            mEntries.remove(key);
+            return null;
+        }
+        return entry != null ? entry.mToken : null;
+    }
+
+    synchronized void put(String key, String token) {
+        long ttl = mTtlMillis;
+        if (key == null || token == null || ttl <= 0) {
+            return;
+        }
+        removeExpired();
+        mEntries.put(key, new Entry(token, SystemClock.elapsedRealtime() + ttl));
+    }
+
+    synchronized void clear() {
+        mEntries.clear();
+        Arrays.fill(mKey, (byte) 0);
+        mRandom.nextBytes(mKey);
+    }
+
+    // Entries put under a key from before the last clear can never be looked
+    // up again; they are dropped here once they expire.
+    private void removeExpired() {
+        long now = SystemClock.elapsedRealtime();
+        Iterator<Entry> iterator = mEntries.values().iterator();
+        while (iterator.hasNext()) {
+            if (iterator.next().mExpiresAt <= now) {
+                iterator.remove();
+            }
+        }
+    }
+
+    private static String toHex(byte[] bytes) {
+        char[] digits = "0123456789abcdef".toCharArray();
+        char[] out = new char[bytes.length * 2];
+        for (int i = 0; i < bytes.length; i++) {
+            out[i * 2] = digits[(bytes[i] >> 4) & 0xf];
+            out[i * 2 + 1] = digits[bytes[i] & 0xf];
+        }
+        return new String(out);
+    }
+
+    private static final class Entry {
+        final String mToken;
+        final long mExpiresAt;
+
+        Entry(String token, long expiresAt) {
+            mToken = token;
+            mExpiresAt = expiresAt;
+        }
+    }
+}
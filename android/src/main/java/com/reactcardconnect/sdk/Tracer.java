@@ -0,0 +1,237 @@
+package com.reactcardconnect.sdk;
+
+import android.os.Process;
+
+import org.json.JSONArray;
+import org.json.JSONException;
+import org.json.JSONObject;
+
+import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Comparator;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Opt-in span tracing exported as Chrome trace JSON. Each thread records
+ * into its own fixed-size buffer, so recording never locks; while tracing is
+ * off every call is one volatile read. Spans are recorded as complete events
+ * when they end, which also covers spans that start and end on different
+ * threads. Spans that share a flow id are linked with flow arrows in the
+ * export.
+ */
+final class Tracer {
+
+    private static final int CAPACITY = 2048;
+
+    private static final class Buffer {
+        // Reassigned when a new thread adopts the buffer of one that exited.
+        volatile WeakReference<Thread> owner;
+        volatile int tid;
+        volatile String threadName;
+        final String[] names = new String[CAPACITY];
+        final long[] starts = new long[CAPACITY];
+        final long[] ends = new long[CAPACITY];
+        final long[] flows = new long[CAPACITY];
+        final char[] phases = new char[CAPACITY];
+        // Written by the owning thread only; volatile so export sees the events.
+        volatile int generation = -1;
+        volatile int count;
+        volatile int dropped;
+    }
+
+    private static volatile boolean sEnabled;
+    private static final AtomicLong sLastFlow = new AtomicLong();
+    private static volatile int sGeneration;
+    private static final ConcurrentLinkedQueue<Buffer> sBuffers = new ConcurrentLinkedQueue<>();
+    private static final ThreadLocal<Buffer> sThreadBuffer = new ThreadLocal<Buffer>() {
+        @Override
+        protected Buffer initialValue() {
+            return adoptBuffer();
+        }
+    };
+
+    private static final Comparator<long[]> SPAN_ORDER = new Comparator<long[]>() {
+        @Override
+        public int compare(long[] a, long[] b) {
+            if (a[0] != b[0]) {
+                return a[0] < b[0] ? -1 : 1;
+            }
+            return a[1] > b[1] ? -1 : a[1] < b[1] ? 1 : 0;
+        }
+    };
+
+    private Tracer() {
+    }
+
+    /** Start time for a span, or 0 while tracing is off. */
+    static long begin() {
+        return sEnabled ? System.nanoTime() : 0;
+    }
+
+    static void end(String name, long start, long flow) {
+        if (start != 0 && sEnabled) {
+            record(name, 'X', start, System.nanoTime(), flow);
+        }
+    }
+
+    static void instant(String name, long flow) {
+        if (sEnabled) {
+            long now = System.nanoTime();
+            record(name, 'i', now, now, flow);
+        }
+    }
+
+    /** A new flow id for one transaction; never 0. */
+    static long nextFlow() {
+        return sLastFlow.incrementAndGet();
+    }
+
+    /** Starting clears whatever the previous session recorded. */
+    static synchronized void setEnabled(boolean enabled) {
+        if (enabled) {
+            sGeneration++;
+        }
+        sEnabled = enabled;
+    }
+
+    /**
+     * Pool threads come and go, so a thread's first event takes over the
+     * buffer of a thread that has exited before a new one is allocated.
+     * This keeps the buffer count at the peak number of tracing threads.
+     */
+    private static Buffer adoptBuffer() {
+        Thread thread = Thread.currentThread();
+        synchronized (sBuffers) {
+            Buffer buffer = null;
+            for (Buffer candidate : sBuffers) {
+                Thread owner = candidate.owner.get();
+                if (owner == null || !owner.isAlive()) {
+                    buffer = candidate;
+                    break;
+                }
+            }
+            if (buffer == null) {
+                buffer = new Buffer();
+                sBuffers.add(buffer);
+            }
+            // Forces a reset on the first record, dropping the previous owner's events.
+            buffer.generation = -1;
+            buffer.tid = Process.myTid();
+            buffer.threadName = thread.getName();
+            buffer.owner = new WeakReference<>(thread);
+            return buffer;
+        }
+    }
+
+    private static void record(String name, char phase, long start, long end, long flow) {
+        Buffer buffer = sThreadBuffer.get();
+        int generation = sGeneration;
+        if (buffer.generation != generation) {
+            buffer.count = 0;
+            buffer.dropped = 0;
+            buffer.generation = generation;
+        }
+
+        int count = buffer.count;
+        if (count == CAPACITY) {
+            buffer.dropped++;
+            return;
+        }
+        buffer.names[count] = name;
+        buffer.starts[count] = start;
+        buffer.ends[count] = end;
+        buffer.flows[count] = flow;
+        buffer.phases[count] = phase;
+        buffer.count = count + 1;
+    }
+
+    /**
+     * The recorded events as a Chrome trace object; dropped[0] receives the
+     * number of events lost to full buffers.
+     */
+    static JSONObject export(int[] dropped) throws JSONException {
+        int generation = sGeneration;
+        int pid = Process.myPid();
+        JSONArray events = new JSONArray();
+        // Start, end and thread of every span with a flow id, keyed by the id.
+        Map<Long, List<long[]>> flows = new HashMap<>();
+        int droppedEvents = 0;
+
+        for (Buffer buffer : sBuffers) {
+            if (buffer.generation != generation) {
+                continue;
+            }
+            int count = buffer.count;
+            if (count == 0) {
+                continue;
+            }
+            droppedEvents += buffer.dropped;
+
+            events.put(new JSONObject()
+                .put("name", "thread_name")
+                .put("ph", "M")
+                .put("pid", pid)
+                .put("tid", buffer.tid)
+                .put("args", new JSONObject().put("name", buffer.threadName)));
+            for (int i = 0; i < count; i++) {
+                JSONObject event = new JSONObject()
+                    .put("name", buffer.names[i])
+                    .put("cat", "cardconnect")
+                    .put("ph", String.valueOf(buffer.phases[i]))
+                    .put("ts", buffer.starts[i] / 1000.0)
+                    .put("pid", pid)
+                    .put("tid", buffer.tid)
+                    .put("args", new JSONObject().put("flow", buffer.flows[i]));
+                if (buffer.phases[i] == 'X') {
+                    event.put("dur", (buffer.ends[i] - buffer.starts[i]) / 1000.0);
+                    if (buffer.flows[i] != 0) {
+                        List<long[]> spans = flows.get(buffer.flows[i]);
+                        if (spans == null) {
+                            spans = new ArrayList<>();
+                            flows.put(buffer.flows[i], spans);
+                        }
+                        spans.add(new long[] {buffer.starts[i], buffer.ends[i], buffer.tid});
+                    }
+                } else {
+                    event.put("s", "t");
+                }
+                events.put(event);
+            }
+        }
+
+        // Flow events bound to the start of each span ("bp": "e" binds to the
+        // enclosing slice) draw arrows from span to span in start order; of
+        // two spans starting together, the outer one comes first.
+        for (Map.Entry<Long, List<long[]>> flow : flows.entrySet()) {
+            List<long[]> spans = flow.getValue();
+            if (spans.size() < 2) {
+                continue;
+            }
+            Collections.sort(spans, SPAN_ORDER);
+            for (int i = 0; i < spans.size(); i++) {
+                long[] span = spans.get(i);
+                events.put(new JSONObject()
+                    .put("name", "flow")
+                    .put("cat", "cardconnect")
+                    .put("ph", i == 0 ? "s" : i == spans.size() - 1 ? "f" : "t")
+                    .put("id", flow.getKey())
+                    .put("bp", "e")
+                    .put("ts", span[0] / 1000.0)
+                    .put("pid", pid)
+                    .put("tid", span[2]));
+            }
+        }
+
+        if (dropped != null && dropped.length > 0) {
+            dropped[0] = droppedEvents;
+        }
+        return new JSONObject()
+            .put("traceEvents", events)
+            .put("displayTimeUnit", "ms");
+    }
+}
@@ -1,7 +0,0 @@
-package com.reactcardconnect.sdk;
-
-public class ValidateException extends RuntimeException {
-    public ValidateException(String message){
-        super(message);
-    }
-}
@@ -1,5 +1,16 @@
-import { NativeModules } from 'react-native';
+import { NativeEventEmitter, NativeModules } from 'react-native';
 
 const { CardConnect } = NativeModules;
 
+export const CardConnectEvents = new NativeEventEmitter(CardConnect);
+
+export { default as CardNumberState } from './card_number_state';
+export {
+  CardNumberFormatter,
+  ExpiryDateFormatter,
+  CVVFormatter,
+  maskCardNumber,
+} from './card_input_format';
+export { TLV, TLVBuilder, RECEIPT_TAGS, receiptFields, hexToBytes, bytesToHex } from './emv_tlv';
+
 export default CardConnect;
@@ -0,0 +1,252 @@
+import CardNumberState from './card_number_state';
+
+/**
+ * Finds the single edit that turns `previous` into `next`: the text in
+ * [start, removedEnd) of `previous` was replaced by [start, insertedEnd) of
+ * `next`.
+ */
+function diff(previous, next) {
+  const max = Math.min(previous.length, next.length);
+  let start = 0;
+  while (start < max && previous[start] === next[start]) {
+    start++;
+  }
+  let end = 0;
+  while (end < max - start && previous[previous.length - 1 - end] === next[next.length - 1 - end]) {
+    end++;
+  }
+  return { start, removedEnd: previous.length - end, insertedEnd: next.length - end };
+}
+
+function countDigits(text, end) {
+  let count = 0;
+  for (let i = 0; i < end; i++) {
+    const code = text.charCodeAt(i);
+    if (code >= 48 && code <= 57) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/**
+ * Shared engine for the input formatters. A change reported by a
+ * TextInput is reduced to the digits it inserted or removed, applied to the
+ * digit state, and the field is laid out again in groups. The cursor stays
+ * behind the last digit the user typed, and the result names the range of
+ * the previous text that actually changed.
+ */
+class DigitFieldFormatter {
+  constructor(separator) {
+    this.separator = separator;
+  }
+
+  /**
+   * Applies the edit between `previousText` and `nextText`, both as shown
+   * in the field, and returns `{ text, selection, change }`. `change` is
+   * `{ start, end, text }`: the range of `previousText` to replace and what
+   * replaces it.
+   */
+  applyChange(previousText, nextText) {
+    const edit = diff(previousText, nextText);
+    let from = countDigits(previousText, edit.start);
+    const to = countDigits(previousText, edit.removedEnd);
+    const inserted = nextText.slice(edit.start, edit.insertedEnd);
+    if (from === to && countDigits(inserted, inserted.length) === 0 && edit.removedEnd > edit.start) {
+      // Backspace over a separator alone would be undone by the next
+      // layout, so it deletes the digit in front of the separator instead.
+      from = Math.max(0, from - 1);
+    }
+
+    this.removeDigits(from, to - from);
+    const cursorDigits = from + this.insertDigits(from, inserted);
+    const text = this.format();
+    const cursor = this.positionAfterDigits(text, cursorDigits);
+    const change = diff(previousText, text);
+    return {
+      text,
+      selection: { start: cursor, end: cursor },
+      change: {
+        start: change.start,
+        end: change.removedEnd,
+        text: text.slice(change.start, change.insertedEnd),
+      },
+    };
+  }
+
+  /** The digits laid out in this field's groups. */
+  format() {
+    const digits = this.digits();
+    const groups = this.groups();
+    let text = '';
+    let offset = 0;
+    for (let i = 0; i < groups.length && offset < digits.length; i++) {
+      if (offset > 0) {
+        text += this.separator;
+      }
+      text += digits.slice(offset, offset + groups[i]);
+      offset += groups[i];
+    }
+    return text + digits.slice(offset);
+  }
+
+  positionAfterDigits(text, count) {
+    if (count === 0) {
+      return 0;
+    }
+    let seen = 0;
+    for (let i = 0; i < text.length; i++) {
+      const code = text.charCodeAt(i);
+      if (code >= 48 && code <= 57 && ++seen === count) {
+        return i + 1;
+      }
+    }
+    return text.length;
+  }
+}
+
+/**
+ * Card number field. Groups follow CCCCardMaskSpacing's every-four layout,
+ * or the issuer's printed layout with `spacing: 'issuer'` (4-6-5 for AMEX,
+ * 4-6-4 for 14 digit Diners). Validation state is available as `card`.
+ */
+export class CardNumberFormatter extends DigitFieldFormatter {
+  constructor({ spacing = 'four', separator = ' ' } = {}) {
+    super(separator);
+    this.spacing = spacing;
+    this.card = new CardNumberState();
+  }
+
+  digits() {
+    return this.card.value;
+  }
+
+  groups() {
+    if (this.spacing === 'none') {
+      return [];
+    }
+    if (this.spacing === 'issuer') {
+      if (this.card.issuer === 'AMEX') {
+        return [4, 6, 5];
+      }
+      if (this.card.issuer === 'DINERS' && this.card.length <= 14) {
+        return [4, 6, 4];
+      }
+    }
+    return [4, 4, 4, 4, 3];
+  }
+
+  removeDigits(index, count) {
+    this.card.remove(index, count);
+  }
+
+  insertDigits(index, text) {
+    const added = this.card.insert(index, text);
+    // The digits just typed may change the issuer and with it the length
+    // limit, so they are kept and the number is trimmed from the end. The
+    // limit is read again after each trim in case the issuer changed.
+    let max = this.card.maxLength;
+    while (max >= 0 && this.card.length > max) {
+      this.card.remove(max, this.card.length - max);
+      max = this.card.maxLength;
+    }
+    return Math.max(0, Math.min(added, this.card.length - index));
+  }
+}
+
+class PlainDigitFormatter extends DigitFieldFormatter {
+  constructor(separator, maxLength) {
+    super(separator);
+    this.maxLength = maxLength;
+    this._digits = '';
+  }
+
+  digits() {
+    return this._digits;
+  }
+
+  removeDigits(index, count) {
+    this._digits = this._digits.slice(0, index) + this._digits.slice(index + count);
+  }
+
+  insertDigits(index, text) {
+    let added = '';
+    for (let i = 0; i < text.length && this._digits.length + added.length < this.maxLength; i++) {
+      const code = text.charCodeAt(i);
+      if (code >= 48 && code <= 57) {
+        added += text[i];
+      }
+    }
+    this._digits = this._digits.slice(0, index) + added + this._digits.slice(index);
+    return added.length;
+  }
+}
+
+/**
+ * MM/YY expiry field. A first digit of 2-9 can only be a single digit
+ * month, so it is completed with a leading zero.
+ */
+export class ExpiryDateFormatter extends PlainDigitFormatter {
+  constructor({ separator = '/' } = {}) {
+    super(separator, 4);
+  }
+
+  groups() {
+    return [2, 2];
+  }
+
+  insertDigits(index, text) {
+    let added = super.insertDigits(index, text);
+    if (index === 0 && added > 0 && this._digits[0] > '1' && this._digits.length < this.maxLength) {
+      this._digits = '0' + this._digits;
+      added++;
+    }
+    return added;
+  }
+
+  /** `{ month, year }` as numbers once both are complete, otherwise null. */
+  get value() {
+    if (this._digits.length < 4) {
+      return null;
+    }
+    return { month: Number(this._digits.slice(0, 2)), year: 2000 + Number(this._digits.slice(2)) };
+  }
+}
+
+/**
+ * CVV field; four digits for AMEX and three otherwise, as the SDK validates
+ * them. Use secureTextEntry on the TextInput to mask it.
+ */
+export class CVVFormatter extends PlainDigitFormatter {
+  constructor({ issuer } = {}) {
+    super('', CVVFormatter.lengthForIssuer(issuer));
+  }
+
+  static lengthForIssuer(issuer) {
+    return issuer === 'AMEX' ? 4 : 3;
+  }
+
+  groups() {
+    return [];
+  }
+
+  /** Call when the card issuer changes; extra digits are dropped. */
+  setIssuer(issuer) {
+    this.maxLength = CVVFormatter.lengthForIssuer(issuer);
+    this._digits = this._digits.slice(0, this.maxLength);
+  }
+}
+
+/**
+ * Masks a card number for display the way CCCCardMaskFormat does:
+ * 'maskWithLastFour', 'lastFour' or 'firstAndLastFour'.
+ */
+export function maskCardNumber(cardNumber, { format = 'maskWithLastFour', character = '•' } = {}) {
+  const digits = cardNumber.replace(/[^0-9]/g, '');
+  const lastFour = digits.slice(-4);
+  if (format === 'lastFour') {
+    return lastFour;
+  }
+  const kept = format === 'firstAndLastFour' ? digits.slice(0, 4) : '';
+  return kept + character.repeat(Math.max(0, digits.length - kept.length - lastFour.length)) + lastFour;
+}
@@ -0,0 +1,185 @@
+// Issuer rules of CCConsumerCardUtils in the Android consumer SDK, in the
+// order it tries them. Each range is an inclusive pair of equal-length
+// prefixes.
+const ISSUERS = [
+  { issuer: 'AMEX', ranges: [['34', '34'], ['37', '37']], lengths: [15] },
+  {
+    issuer: 'DINERS',
+    ranges: [['300', '305'], ['309', '309'], ['36', '36'], ['38', '39'], ['54', '55']],
+    lengths: [14, 16],
+  },
+  {
+    issuer: 'DISC',
+    ranges: [['6011', '6011'], ['65', '65'], ['644', '649'], ['622126', '622925']],
+    lengths: [16, 19],
+  },
+  { issuer: 'JCB', ranges: [['3528', '3589']], lengths: [16, 19] },
+  { issuer: 'MC', ranges: [['2221', '2720'], ['51', '55']], lengths: [16] },
+  { issuer: 'VISA', ranges: [['4', '4']], lengths: [13, 16, 19] },
+  {
+    issuer: 'MAESTRO',
+    ranges: [['50', '50'], ['56', '59'], ['6', '6']],
+    lengths: [12, 13, 14, 15, 16, 17, 18, 19],
+  },
+];
+
+// Issuer prefixes never run past six digits, so only edits inside them
+// need the issuer worked out again.
+const PREFIX_LENGTH = 6;
+const MAX_LENGTH = 19;
+
+// Luhn value of a digit in a doubled position.
+const DOUBLED = [0, 2, 4, 6, 8, 1, 3, 5, 7, 9];
+
+function rangeState(prefix, [low, high]) {
+  if (prefix.length >= low.length) {
+    const head = prefix.slice(0, low.length);
+    return head >= low && head <= high ? 'match' : 'none';
+  }
+  // Some continuation of the prefix can still land inside the range.
+  const floor = prefix.padEnd(low.length, '0');
+  const ceiling = prefix.padEnd(low.length, '9');
+  return ceiling >= low && floor <= high ? 'possible' : 'none';
+}
+
+/**
+ * Card number validation state that is updated per edit instead of being
+ * recomputed from the whole string. Running Luhn sums are kept for both
+ * digit parities, so typing or deleting at the end of the number costs the
+ * same whatever its length; an edit in the middle only revisits the digits
+ * after it. The issuer and its length bounds follow the Android consumer
+ * SDK's rules, so on Android `valid` agrees with the validation run by
+ * getCardToken. The iOS SDK's CCC_* checks use their own issuer ranges and
+ * lengths and can disagree on edge cases; validateCards reports the native
+ * result per platform.
+ *
+ * Non-digit characters in inserted text are ignored, so pasted numbers with
+ * spaces or dashes are accepted as is.
+ */
+export default class CardNumberState {
+  constructor(text = '') {
+    this._digits = [];
+    // Sums of the digits at even and odd positions from the left, taken
+    // plainly and doubled. Which pair makes up the Luhn total depends on the
+    // parity of the length.
+    this._plain = [0, 0];
+    this._doubled = [0, 0];
+    this._issuer = 'NONE';
+    this._candidates = ISSUERS.map(({ issuer }) => issuer);
+    this.insert(0, text);
+  }
+
+  get value() {
+    return this._digits.join('');
+  }
+
+  get length() {
+    return this._digits.length;
+  }
+
+  /** The SDK issuer code for the digits so far: AMEX, VISA, MC, DISC, DINERS, JCB, MAESTRO, OTHER or NONE. */
+  get issuer() {
+    return this._issuer;
+  }
+
+  /** Issuers the number can still turn out to be as more digits are typed. */
+  get candidates() {
+    return this._candidates;
+  }
+
+  /** The longest number the current issuer allows, or -1 when there is none. */
+  get maxLength() {
+    const rule = this._rule();
+    return rule ? rule.lengths[rule.lengths.length - 1] : -1;
+  }
+
+  get lengthValid() {
+    const rule = this._rule();
+    return rule ? rule.lengths.includes(this._digits.length) : false;
+  }
+
+  get luhnValid() {
+    if (this._digits.length === 0) {
+      return false;
+    }
+    // The last digit is never doubled, so the doubled positions are those
+    // whose parity differs from the last index.
+    const last = (this._digits.length - 1) % 2;
+    return (this._plain[last] + this._doubled[1 - last]) % 10 === 0;
+  }
+
+  get valid() {
+    return this.lengthValid && this.luhnValid;
+  }
+
+  /** Inserts the digits of `text` at `index` and returns the number of digits inserted. */
+  insert(index, text) {
+    const added = [];
+    for (let i = 0; i < text.length && this._digits.length + added.length < MAX_LENGTH; i++) {
+      const code = text.charCodeAt(i) - 48;
+      if (code >= 0 && code <= 9) {
+        added.push(code);
+      }
+    }
+    if (added.length > 0) {
+      this._splice(index, 0, added);
+    }
+    return added.length;
+  }
+
+  /** Removes `count` digits starting at `index`. */
+  remove(index, count = 1) {
+    const removed = Math.min(count, this._digits.length - index);
+    if (removed > 0) {
+      this._splice(index, removed, []);
+    }
+  }
+
+  /** Replaces the whole number, for example when the field is cleared. */
+  reset(text = '') {
+    this.remove(0, this._digits.length);
+    this.insert(0, text);
+  }
+
+  _splice(index, removeCount, added) {
+    const start = Math.max(0, Math.min(index, this._digits.length));
+    // Every digit after the edit may change position parity, so take them
+    // out of the sums and put them back afterwards. Appending at the end
+    // leaves nothing to revisit.
+    this._account(start, this._digits.length, -1);
+    this._digits.splice(start, removeCount, ...added);
+    this._account(start, this._digits.length, 1);
+    if (start < PREFIX_LENGTH) {
+      this._classify();
+    }
+  }
+
+  _account(from, to, sign) {
+    for (let i = from; i < to; i++) {
+      const digit = this._digits[i];
+      this._plain[i % 2] += sign * digit;
+      this._doubled[i % 2] += sign * DOUBLED[digit];
+    }
+  }
+
+  _classify() {
+    const prefix = this._digits.slice(0, PREFIX_LENGTH).join('');
+    this._issuer = prefix.length === 0 ? 'NONE' : 'OTHER';
+    this._candidates = [];
+    let decided = false;
+    for (const rule of ISSUERS) {
+      const states = rule.ranges.map(range => rangeState(prefix, range));
+      if (!decided && states.includes('match')) {
+        this._issuer = rule.issuer;
+        decided = true;
+      }
+      if (states.some(state => state !== 'none')) {
+        this._candidates.push(rule.issuer);
+      }
+    }
+  }
+
+  _rule() {
+    return ISSUERS.find(({ issuer }) => issuer === this._issuer);
+  }
+}
@@ -0,0 +1,317 @@
+// EMV tags printed on receipts, as used by receiptFields.
+export const RECEIPT_TAGS = {
+  aid: 0x4f,
+  applicationLabel: 0x50,
+  preferredName: 0x9f12,
+  tvr: 0x95,
+  tsi: 0x9b,
+  cryptogram: 0x9f26,
+  cryptogramInformation: 0x9f27,
+  atc: 0x9f36,
+  unpredictableNumber: 0x9f37,
+  cvmResults: 0x9f34,
+  panSequenceNumber: 0x5f34,
+  transactionDate: 0x9a,
+  transactionType: 0x9c,
+  amountAuthorized: 0x9f02,
+  terminalCountryCode: 0x9f1a,
+  currencyCode: 0x5f2a,
+  issuerApplicationData: 0x9f10,
+};
+
+// Tags whose values are text rather than binary.
+const TEXT_TAGS = [0x50, 0x9f12];
+
+// EMV data nests templates only a few levels deep (77 > A5 > BF0C); anything
+// deeper is treated as malformed rather than walked.
+const MAX_DEPTH = 16;
+
+// Lookup tables for hex: the nibble for each ASCII code, with 0x80 flagging
+// non-hex characters, and the two-character string for each byte.
+const NIBBLES = new Uint8Array(128).fill(0x80);
+const PAIRS = [];
+for (let i = 0; i < 16; i++) {
+  const digit = '0123456789ABCDEF'[i];
+  NIBBLES[digit.charCodeAt(0)] = i;
+  NIBBLES[digit.toLowerCase().charCodeAt(0)] = i;
+}
+for (let i = 0; i < 256; i++) {
+  PAIRS.push('0123456789ABCDEF'[i >> 4] + '0123456789ABCDEF'[i & 0x0f]);
+}
+
+/**
+ * Decodes the hex string `hex` into `out`, or a new Uint8Array when `out` is
+ * omitted, and returns the bytes. Throws on odd lengths and non-hex
+ * characters.
+ */
+export function hexToBytes(hex, out = new Uint8Array(hex.length >> 1)) {
+  const length = hex.length >> 1;
+  if (hex.length % 2 !== 0 || out.length < length) {
+    throw new Error(`Invalid hex string: ${hex}`);
+  }
+  let invalid = 0;
+  for (let i = 0; i < length; i++) {
+    // Codes past ASCII are clamped onto DEL, which is flagged like any other
+    // non-hex character.
+    const high = NIBBLES[Math.min(hex.charCodeAt(i * 2), 127)];
+    const low = NIBBLES[Math.min(hex.charCodeAt(i * 2 + 1), 127)];
+    invalid |= high | low;
+    out[i] = (high << 4) | low;
+  }
+  if (invalid & 0x80) {
+    throw new Error(`Invalid hex string: ${hex}`);
+  }
+  return out.length === length ? out : out.subarray(0, length);
+}
+
+function toBytes(value) {
+  if (value instanceof Uint8Array) {
+    return value;
+  }
+  if (typeof value === 'string') {
+    return hexToBytes(value);
+  }
+  if (Array.isArray(value)) {
+    return Uint8Array.from(value);
+  }
+  throw new TypeError('TLV data must be a hex string, a Uint8Array or an array of bytes');
+}
+
+export function bytesToHex(bytes) {
+  let hex = '';
+  for (let i = 0; i < bytes.length; i++) {
+    hex += PAIRS[bytes[i]];
+  }
+  return hex;
+}
+
+function tagBytes(tag) {
+  const bytes = [];
+  for (let rest = tag >>> 0; rest > 0 || bytes.length === 0; rest = Math.floor(rest / 256)) {
+    bytes.unshift(rest & 0xff);
+  }
+  return bytes;
+}
+
+function lengthBytes(length) {
+  if (length < 0x80) {
+    return [length];
+  }
+  const bytes = [];
+  for (let rest = length; rest > 0; rest = Math.floor(rest / 256)) {
+    bytes.unshift(rest & 0xff);
+  }
+  return [0x80 | bytes.length, ...bytes];
+}
+
+/**
+ * BER-TLV data as found in EMV card reads, receipt data and the reader
+ * configs. Parsing builds a flat index of every object, including those
+ * nested in constructed templates such as 70 or 77; values are returned as
+ * views into the original bytes, nothing is copied. Tags are numbers made
+ * of their bytes, so 9F26 is 0x9f26.
+ *
+ * Throws on malformed data: truncated tags, lengths or values, indefinite
+ * lengths, tags or lengths longer than four bytes, and templates nested
+ * more than 16 deep. Input other than hex, a Uint8Array or a byte array
+ * throws a TypeError.
+ */
+export class TLV {
+  constructor(data) {
+    this.bytes = toBytes(data);
+    this.count = 0;
+    this._tags = new Uint32Array(16);
+    // Value offset and length, and the index of the enclosing template
+    // (-1 at the top level), per object in document order.
+    this._offsets = new Int32Array(16);
+    this._lengths = new Int32Array(16);
+    this._parents = new Int32Array(16);
+    this._parse(0, this.bytes.length, -1, 0);
+  }
+
+  /** Index of the first object with `tag` at or after index `from`, or -1. */
+  indexOf(tag, from = 0) {
+    for (let i = from; i < this.count; i++) {
+      if (this._tags[i] === tag) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  has(tag) {
+    return this.indexOf(tag) >= 0;
+  }
+
+  /** The value of the first object with `tag`, as a view into the data, or null. */
+  get(tag) {
+    const index = this.indexOf(tag);
+    return index < 0 ? null : this.valueAt(index);
+  }
+
+  getHex(tag) {
+    const value = this.get(tag);
+    return value ? bytesToHex(value) : null;
+  }
+
+  tagAt(index) {
+    return this._tags[index];
+  }
+
+  valueAt(index) {
+    const offset = this._offsets[index];
+    return this.bytes.subarray(offset, offset + this._lengths[index]);
+  }
+
+  /** Index of the template holding the object at `index`, or -1 at the top level. */
+  parentAt(index) {
+    return this._parents[index];
+  }
+
+  _parse(start, end, parent, depth) {
+    const bytes = this.bytes;
+    let position = start;
+    while (position < end) {
+      // 00 and FF may pad between objects.
+      if (bytes[position] === 0x00 || bytes[position] === 0xff) {
+        position++;
+        continue;
+      }
+
+      const tagStart = position;
+      let tag = bytes[position++];
+      if ((tag & 0x1f) === 0x1f) {
+        do {
+          if (position >= end || position - tagStart === 4) {
+            throw new Error(`Malformed TLV tag at offset ${tagStart}`);
+          }
+          tag = tag * 256 + bytes[position];
+        } while (bytes[position++] & 0x80);
+      }
+      const constructed = (bytes[tagStart] & 0x20) !== 0;
+
+      if (position >= end) {
+        throw new Error(`Missing TLV length at offset ${position}`);
+      }
+      let length = bytes[position++];
+      if (length & 0x80) {
+        const size = length & 0x7f;
+        if (size === 0 || size > 4 || position + size > end) {
+          throw new Error(`Malformed TLV length at offset ${position - 1}`);
+        }
+        length = 0;
+        for (let i = 0; i < size; i++) {
+          length = length * 256 + bytes[position++];
+        }
+      }
+      if (length > end - position) {
+        throw new Error(`TLV value for tag ${tag.toString(16).toUpperCase()} runs past the end of the data`);
+      }
+
+      const index = this._append(tag, position, length, parent);
+      if (constructed) {
+        if (depth === MAX_DEPTH) {
+          throw new Error(`TLV templates nested too deeply at offset ${tagStart}`);
+        }
+        this._parse(position, position + length, index, depth + 1);
+      }
+      position += length;
+    }
+  }
+
+  _append(tag, offset, length, parent) {
+    if (this.count === this._tags.length) {
+      const capacity = this.count * 2;
+      const grow = (array) => {
+        const grown = new array.constructor(capacity);
+        grown.set(array);
+        return grown;
+      };
+      this._tags = grow(this._tags);
+      this._offsets = grow(this._offsets);
+      this._lengths = grow(this._lengths);
+      this._parents = grow(this._parents);
+    }
+    const index = this.count++;
+    this._tags[index] = tag;
+    this._offsets[index] = offset;
+    this._lengths[index] = length;
+    this._parents[index] = parent;
+    return index;
+  }
+}
+
+/**
+ * Encodes BER-TLV. Values may be Uint8Arrays, hex strings or byte arrays;
+ * `open` and `close` wrap the objects added in between in a constructed
+ * template.
+ */
+export class TLVBuilder {
+  constructor() {
+    this._stack = [{ tag: null, chunks: [], length: 0 }];
+  }
+
+  add(tag, value) {
+    this._write(tagBytes(tag), toBytes(value));
+    return this;
+  }
+
+  open(tag) {
+    this._stack.push({ tag, chunks: [], length: 0 });
+    return this;
+  }
+
+  close() {
+    if (this._stack.length === 1) {
+      throw new Error('No open TLV template to close');
+    }
+    const template = this._stack.pop();
+    this._write(tagBytes(template.tag), this._join(template));
+    return this;
+  }
+
+  toBytes() {
+    if (this._stack.length !== 1) {
+      throw new Error('TLV template left open');
+    }
+    return this._join(this._stack[0]);
+  }
+
+  toHex() {
+    return bytesToHex(this.toBytes());
+  }
+
+  _write(tag, value) {
+    const top = this._stack[this._stack.length - 1];
+    const header = tag.concat(lengthBytes(value.length));
+    top.chunks.push(header, value);
+    top.length += header.length + value.length;
+  }
+
+  _join(template) {
+    const bytes = new Uint8Array(template.length);
+    let offset = 0;
+    for (const chunk of template.chunks) {
+      bytes.set(chunk, offset);
+      offset += chunk.length;
+    }
+    return bytes;
+  }
+}
+
+/**
+ * The receipt fields present in `tlv` (a TLV, or data to parse), keyed as
+ * in RECEIPT_TAGS. Labels are decoded as text and everything else is hex.
+ */
+export function receiptFields(tlv) {
+  const parsed = tlv instanceof TLV ? tlv : new TLV(tlv);
+  const fields = {};
+  for (const name of Object.keys(RECEIPT_TAGS)) {
+    const tag = RECEIPT_TAGS[name];
+    const value = parsed.get(tag);
+    if (value) {
+      fields[name] = TEXT_TAGS.includes(tag) ? String.fromCharCode(...value).trim() : bytesToHex(value);
+    }
+  }
+  return fields;
+}
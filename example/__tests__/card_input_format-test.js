@@ -0,0 +1,55 @@
+/**
+ * @format
+ */
+
+import {
+  CardNumberFormatter,
+  ExpiryDateFormatter,
+  maskCardNumber,
+} from '../../card_input_format';
+
+function formatterWith(text, options) {
+  const formatter = new CardNumberFormatter(options);
+  formatter.applyChange('', text);
+  return formatter;
+}
+
+it('deletes the digit before a separator on backspace', () => {
+  const formatter = formatterWith('42424');
+  const result = formatter.applyChange('4242 4', '42424');
+  expect(result.text).toBe('4244');
+  expect(result.selection).toEqual({ start: 3, end: 3 });
+});
+
+it('caps a paste at 19 digits', () => {
+  const result = new CardNumberFormatter().applyChange('', '4111 1111 1111 1111 1119999');
+  expect(result.text).toBe('4111 1111 1111 1111 111');
+  expect(result.selection.start).toBe(result.text.length);
+});
+
+it('groups AMEX numbers 4-6-5 with issuer spacing', () => {
+  const result = new CardNumberFormatter({ spacing: 'issuer' }).applyChange('', '378282246310005');
+  expect(result.text).toBe('3782 822463 10005');
+});
+
+it('keeps a typed digit that switches to an issuer with a shorter limit', () => {
+  const formatter = formatterWith('3111111111111111');
+  const result = formatter.applyChange('3111 1111 1111 1111', '37111 1111 1111 1111');
+  expect(result.text).toBe('3711 1111 1111 111');
+  expect(result.selection).toEqual({ start: 2, end: 2 });
+  expect(formatter.card.issuer).toBe('AMEX');
+  expect(formatter.card.length).toBe(15);
+});
+
+it('completes a single digit expiry month', () => {
+  const formatter = new ExpiryDateFormatter();
+  const result = formatter.applyChange('', '325');
+  expect(result.text).toBe('03/25');
+  expect(formatter.value).toEqual({ month: 3, year: 2025 });
+});
+
+it('masks card numbers in the SDK formats', () => {
+  expect(maskCardNumber('4111111111111111')).toBe('••••••••••••1111');
+  expect(maskCardNumber('4111111111111111', { format: 'firstAndLastFour' })).toBe('4111••••••••1111');
+  expect(maskCardNumber('4111 1111 1111 1111', { format: 'lastFour' })).toBe('1111');
+});
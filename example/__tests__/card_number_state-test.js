@@ -0,0 +1,84 @@
+/**
+ * @format
+ */
+
+import CardNumberState from '../../card_number_state';
+
+function luhn(value) {
+  let sum = 0;
+  for (let i = 0; i < value.length; i++) {
+    let digit = Number(value[value.length - 1 - i]);
+    if (i % 2 === 1) {
+      digit = digit * 2 > 9 ? digit * 2 - 9 : digit * 2;
+    }
+    sum += digit;
+  }
+  return value.length > 0 && sum % 10 === 0;
+}
+
+// Small deterministic generator so failures reproduce.
+function random(seed) {
+  let state = seed;
+  return (limit) => {
+    state = (state * 1103515245 + 12345) % 2147483648;
+    return state % limit;
+  };
+}
+
+it('matches a full recompute after every incremental edit', () => {
+  const next = random(46);
+  const state = new CardNumberState();
+  let value = '';
+  for (let step = 0; step < 5000; step++) {
+    const index = next(value.length + 1);
+    if (value.length > 0 && next(3) === 0) {
+      const count = 1 + next(3);
+      state.remove(index, count);
+      value = value.slice(0, index) + value.slice(index + count);
+    } else {
+      let text = '';
+      const length = 1 + next(4);
+      for (let i = 0; i < length; i++) {
+        text += String(next(10));
+      }
+      const added = state.insert(index, text);
+      value = value.slice(0, index) + text.slice(0, added) + value.slice(index);
+    }
+
+    const fresh = new CardNumberState(value);
+    expect(state.value).toBe(value);
+    expect(state.luhnValid).toBe(luhn(value));
+    expect(state.issuer).toBe(fresh.issuer);
+    expect(state.candidates).toEqual(fresh.candidates);
+  }
+});
+
+it('classifies issuers at the range boundaries', () => {
+  const issuers = {
+    2220: 'OTHER',
+    2221: 'MC',
+    2720: 'MC',
+    2721: 'OTHER',
+    622125: 'MAESTRO',
+    622126: 'DISC',
+    622925: 'DISC',
+    622926: 'MAESTRO',
+    643: 'MAESTRO',
+    644: 'DISC',
+    649: 'DISC',
+    3527: 'OTHER',
+    3528: 'JCB',
+    3589: 'JCB',
+    3590: 'OTHER',
+  };
+  Object.keys(issuers).forEach((prefix) => {
+    expect([prefix, new CardNumberState(prefix).issuer]).toEqual([prefix, issuers[prefix]]);
+  });
+});
+
+it('validates length and Luhn together', () => {
+  expect(new CardNumberState('4111111111111111').valid).toBe(true);
+  expect(new CardNumberState('4111111111111112').valid).toBe(false);
+  expect(new CardNumberState('378282246310005').valid).toBe(true);
+  expect(new CardNumberState('37828224631000').lengthValid).toBe(false);
+});
@@ -0,0 +1,45 @@
+/**
+ * @format
+ */
+
+import { TLV, TLVBuilder, receiptFields } from '../../emv_tlv';
+
+it('indexes nested templates and reads receipt tags', () => {
+  const tlv = new TLV('770E9F2608C1D2E3F4A5B6C7D8950100');
+  expect(tlv.count).toBe(3);
+  expect(tlv.parentAt(1)).toBe(0);
+  expect(tlv.getHex(0x9f26)).toBe('C1D2E3F4A5B6C7D8');
+  expect(receiptFields(tlv)).toEqual({ tvr: '00', cryptogram: 'C1D2E3F4A5B6C7D8' });
+});
+
+it('round trips through the builder', () => {
+  const hex = new TLVBuilder().open(0x70).add(0x4f, 'A0000000031010').close().toHex();
+  expect(hex).toBe('70094F07A0000000031010');
+  expect(new TLV(hex).getHex(0x4f)).toBe('A0000000031010');
+});
+
+it('rejects deeply nested templates with a parse error', () => {
+  // 10,000 70 templates, each wrapping the next, around an empty one.
+  let bytes = new Uint8Array(0);
+  for (let i = 0; i < 10000; i++) {
+    const length = bytes.length;
+    const header = length < 0x80 ? [0x70, length] : [0x70, 0x82, length >> 8, length & 0xff];
+    const next = new Uint8Array(header.length + length);
+    next.set(header);
+    next.set(bytes, header.length);
+    bytes = next;
+  }
+  expect(() => new TLV(bytes)).toThrow(/nested too deeply/);
+});
+
+it('rejects truncated and malformed data', () => {
+  expect(() => new TLV('9F')).toThrow(/Malformed TLV tag/);
+  expect(() => new TLV('5F2A0308')).toThrow(/runs past the end/);
+  expect(() => new TLV('5F2A80')).toThrow(/Malformed TLV length/);
+  expect(() => new TLV('5G')).toThrow(/Invalid hex/);
+});
+
+it('rejects unsupported input types', () => {
+  expect(() => new TLV({ aid: 'A0000000031010' })).toThrow(TypeError);
+  expect(() => receiptFields({})).toThrow(TypeError);
+});
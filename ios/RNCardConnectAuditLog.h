@@ -0,0 +1,46 @@
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(uint8_t, RNCardConnectAuditKind) {
+    RNCardConnectAuditKindToken,
+    RNCardConnectAuditKindSwipe,
+};
+
+typedef NS_ENUM(NSInteger, RNCardConnectAuditSync) {
+    /** Leave flushing to the OS. */
+    RNCardConnectAuditSyncNever,
+    /** fsync when a segment is closed. */
+    RNCardConnectAuditSyncSegment,
+    /** fsync after every drain that wrote records. */
+    RNCardConnectAuditSyncBatch,
+};
+
+/**
+ Audit trail of tokenization and swipe results, written as NDJSON segments
+ in a directory. record: copies the fields into a fixed-size slot of a
+ lock-free ring buffer and never blocks or touches the disk; a background
+ queue drains the ring, rotating segments at maxSegmentBytes and keeping
+ the newest maxSegments. When the ring is full new records are dropped and
+ counted rather than stalling the caller.
+ */
+@interface RNCardConnectAuditLog : NSObject
+
+- (instancetype)initWithDirectory:(NSString *)directory
+                  maxSegmentBytes:(unsigned long long)maxSegmentBytes
+                      maxSegments:(NSUInteger)maxSegments
+                             sync:(RNCardConnectAuditSync)sync;
+
+/** Safe to call from any thread. Pass a negative latency when unknown. */
+- (void)recordKind:(RNCardConnectAuditKind)kind
+  maskedCardNumber:(NSString *)maskedCardNumber
+             token:(NSString *)token
+            issuer:(NSString *)issuer
+              code:(NSString *)code
+           latency:(double)latency;
+
+/** Drains what is buffered, closes the current segment and stops the writer. */
+- (void)closeWithCompletion:(dispatch_block_t)completion;
+
+/** Records accepted, dropped on overflow and written so far, plus the segment paths. */
+- (NSDictionary *)stats;
+
+@end
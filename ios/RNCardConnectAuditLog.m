@@ -0,0 +1,278 @@
+#import "RNCardConnectAuditLog.h"
+#import <stdatomic.h>
+#import <unistd.h>
+
+// Power of two so a position maps to its slot with a mask.
+static size_t const RNCardConnectAuditCapacity = 1024;
+// Producers poke the writer every this many records so a burst is drained
+// before the ring fills, instead of waiting for the next tick.
+static size_t const RNCardConnectAuditKickInterval = 256;
+static double const RNCardConnectAuditDrainInterval = 1.0;
+
+typedef struct {
+    double timestamp;
+    double latency;
+    RNCardConnectAuditKind kind;
+    char maskedCardNumber[24];
+    char token[40];
+    char issuer[16];
+    char code[24];
+} RNCardConnectAuditRecord;
+
+/**
+ Each slot carries a sequence number that tells producers and the consumer
+ whose turn it is (Vyukov's bounded queue): equal to the position when the
+ slot is free for that position, position + 1 once it holds a record.
+ */
+typedef struct {
+    _Atomic size_t sequence;
+    RNCardConnectAuditRecord record;
+} RNCardConnectAuditSlot;
+
+static void RNCardConnectAuditCopy(char *destination, size_t size, NSString *string)
+{
+    const char *utf8 = string.UTF8String;
+    strlcpy(destination, utf8 ?: "", size);
+}
+
+static id RNCardConnectAuditValue(const char *string)
+{
+    return string[0] ? @(string) : [NSNull null];
+}
+
+@implementation RNCardConnectAuditLog
+{
+    RNCardConnectAuditSlot *_slots;
+    _Atomic size_t _enqueuePosition;
+    // Only touched on _queue.
+    size_t _dequeuePosition;
+    _Atomic unsigned long long _recorded;
+    _Atomic unsigned long long _dropped;
+
+    NSString *_directory;
+    unsigned long long _maxSegmentBytes;
+    NSUInteger _maxSegments;
+    RNCardConnectAuditSync _sync;
+
+    dispatch_queue_t _queue;
+    dispatch_source_t _kick;
+    dispatch_source_t _timer;
+    NSFileHandle *_segment;
+    unsigned long long _segmentBytes;
+    unsigned long long _written;
+}
+
+- (instancetype)initWithDirectory:(NSString *)directory
+                  maxSegmentBytes:(unsigned long long)maxSegmentBytes
+                      maxSegments:(NSUInteger)maxSegments
+                             sync:(RNCardConnectAuditSync)sync
+{
+    if ((self = [super init])) {
+        _slots = calloc(RNCardConnectAuditCapacity, sizeof(RNCardConnectAuditSlot));
+        for (size_t i = 0; i < RNCardConnectAuditCapacity; i++) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_recorded, 0);
+        atomic_init(&_dropped, 0);
+
+        _directory = [directory copy];
+        _maxSegmentBytes = MAX(maxSegmentBytes, 1024);
+        _maxSegments = MAX(maxSegments, 1);
+        _sync = sync;
+        [[NSFileManager defaultManager] createDirectoryAtPath:_directory withIntermediateDirectories:YES attributes:nil error:NULL];
+
+        _queue = dispatch_queue_create("com.reactcardconnect.audit", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        __weak __typeof(self) weakSelf = self;
+        _kick = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, _queue);
+        dispatch_source_set_event_handler(_kick, ^{
+            [weakSelf drain];
+        });
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        dispatch_source_set_timer(_timer,
+                                  dispatch_time(DISPATCH_TIME_NOW, (int64_t)(RNCardConnectAuditDrainInterval * NSEC_PER_SEC)),
+                                  (uint64_t)(RNCardConnectAuditDrainInterval * NSEC_PER_SEC),
+                                  (uint64_t)(0.25 * NSEC_PER_SEC));
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf drain];
+        });
+        dispatch_resume(_kick);
+        dispatch_resume(_timer);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_kick);
+    dispatch_source_cancel(_timer);
+    [_segment closeFile];
+    // Tokens and masked numbers should not linger in freed memory.
+    memset_s(_slots, RNCardConnectAuditCapacity * sizeof(RNCardConnectAuditSlot), 0, RNCardConnectAuditCapacity * sizeof(RNCardConnectAuditSlot));
+    free(_slots);
+}
+
+- (void)recordKind:(RNCardConnectAuditKind)kind
+  maskedCardNumber:(NSString *)maskedCardNumber
+             token:(NSString *)token
+            issuer:(NSString *)issuer
+              code:(NSString *)code
+           latency:(double)latency
+{
+    size_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    RNCardConnectAuditSlot *slot;
+    while (YES) {
+        slot = &_slots[position & (RNCardConnectAuditCapacity - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The writer has not caught up with a full lap of the ring.
+            atomic_fetch_add_explicit(&_dropped, 1, memory_order_relaxed);
+            dispatch_source_merge_data(_kick, 1);
+            return;
+        } else {
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+
+    RNCardConnectAuditRecord *record = &slot->record;
+    record->timestamp = [NSDate timeIntervalSinceReferenceDate] + NSTimeIntervalSince1970;
+    record->latency = latency;
+    record->kind = kind;
+    RNCardConnectAuditCopy(record->maskedCardNumber, sizeof(record->maskedCardNumber), maskedCardNumber);
+    RNCardConnectAuditCopy(record->token, sizeof(record->token), token);
+    RNCardConnectAuditCopy(record->issuer, sizeof(record->issuer), issuer);
+    RNCardConnectAuditCopy(record->code, sizeof(record->code), code);
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&_recorded, 1, memory_order_relaxed);
+    if ((position + 1) % RNCardConnectAuditKickInterval == 0) {
+        dispatch_source_merge_data(_kick, 1);
+    }
+}
+
+- (void)closeWithCompletion:(dispatch_block_t)completion
+{
+    dispatch_async(_queue, ^{
+        dispatch_source_cancel(self->_kick);
+        dispatch_source_cancel(self->_timer);
+        [self drain];
+        [self closeSegment];
+        if (completion) {
+            completion();
+        }
+    });
+}
+
+- (NSDictionary *)stats
+{
+    __block unsigned long long written;
+    __block NSArray<NSString *> *files;
+    dispatch_sync(_queue, ^{
+        written = self->_written;
+        files = [self segmentPaths];
+    });
+    return @{
+        @"recorded": @(atomic_load_explicit(&_recorded, memory_order_relaxed)),
+        @"dropped": @(atomic_load_explicit(&_dropped, memory_order_relaxed)),
+        @"written": @(written),
+        @"files": files,
+    };
+}
+
+#pragma mark - Private
+
+/** Runs on _queue, the ring's only consumer. */
+- (void)drain
+{
+    NSMutableData *batch = [NSMutableData new];
+    NSUInteger count = 0;
+    while (YES) {
+        RNCardConnectAuditSlot *slot = &_slots[_dequeuePosition & (RNCardConnectAuditCapacity - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != _dequeuePosition + 1) {
+            break;
+        }
+        RNCardConnectAuditRecord record = slot->record;
+        memset_s(&slot->record, sizeof(slot->record), 0, sizeof(slot->record));
+        atomic_store_explicit(&slot->sequence, _dequeuePosition + RNCardConnectAuditCapacity, memory_order_release);
+        _dequeuePosition++;
+
+        NSDictionary *line = @{
+            @"time": @(record.timestamp),
+            @"kind": record.kind == RNCardConnectAuditKindSwipe ? @"swipe" : @"token",
+            @"maskedCardNumber": RNCardConnectAuditValue(record.maskedCardNumber),
+            @"token": RNCardConnectAuditValue(record.token),
+            @"issuer": RNCardConnectAuditValue(record.issuer),
+            @"code": RNCardConnectAuditValue(record.code),
+            @"latency": record.latency >= 0 ? @(record.latency) : [NSNull null],
+        };
+        [batch appendData:[NSJSONSerialization dataWithJSONObject:line options:0 error:NULL]];
+        [batch appendBytes:"\n" length:1];
+        count++;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    if (!_segment || _segmentBytes >= _maxSegmentBytes) {
+        [self closeSegment];
+        [self openSegment];
+    }
+    [_segment writeData:batch];
+    _segmentBytes += batch.length;
+    _written += count;
+    if (_sync == RNCardConnectAuditSyncBatch) {
+        fsync(_segment.fileDescriptor);
+    }
+}
+
+- (void)openSegment
+{
+    NSString *name = [NSString stringWithFormat:@"audit-%.0f.ndjson", [NSDate date].timeIntervalSince1970 * 1000];
+    NSString *path = [_directory stringByAppendingPathComponent:name];
+    [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:@{
+        NSFileProtectionKey: NSFileProtectionCompleteUntilFirstUserAuthentication,
+    }];
+    _segment = [NSFileHandle fileHandleForWritingAtPath:path];
+    [_segment seekToEndOfFile];
+    _segmentBytes = _segment.offsetInFile;
+
+    NSArray<NSString *> *paths = [self segmentPaths];
+    if (paths.count > _maxSegments) {
+        for (NSString *old in [paths subarrayWithRange:NSMakeRange(0, paths.count - _maxSegments)]) {
+            [[NSFileManager defaultManager] removeItemAtPath:old error:NULL];
+        }
+    }
+}
+
+- (void)closeSegment
+{
+    if (!_segment) {
+        return;
+    }
+    if (_sync != RNCardConnectAuditSyncNever) {
+        fsync(_segment.fileDescriptor);
+    }
+    [_segment closeFile];
+    _segment = nil;
+}
+
+/** Oldest first; the names sort by creation time. */
+- (NSArray<NSString *> *)segmentPaths
+{
+    NSArray<NSString *> *names = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_directory error:NULL];
+    NSMutableArray<NSString *> *paths = [NSMutableArray new];
+    for (NSString *name in [names sortedArrayUsingSelector:@selector(compare:)]) {
+        if ([name hasPrefix:@"audit-"] && [name.pathExtension isEqualToString:@"ndjson"]) {
+            [paths addObject:[_directory stringByAppendingPathComponent:name]];
+        }
+    }
+    return paths;
+}
+
+@end
@@ -0,0 +1,17 @@
+#import <Foundation/Foundation.h>
+
+/**
+ Hex decoding for reader payloads (CAPK moduli, terminal data, AIDs). It is
+ table driven and writes into a caller-supplied buffer, so converting a
+ field costs one pass and no per-byte allocation.
+ */
+
+/**
+ Decodes `length` hex characters, either case, into `length / 2` bytes at
+ `out`. Returns NO, leaving `out` unspecified, for an odd length or any
+ non-hex character.
+ */
+BOOL RNCardConnectHexDecode(const char *hex, size_t length, uint8_t *out);
+
+/** The bytes of a hex string, or nil when `hex` is not a string of valid hex. */
+NSData *RNCardConnectDataFromHex(id hex);
@@ -0,0 +1,70 @@
+#import "RNCardConnectHex.h"
+
+// Nibble value per character; 0x80 marks a non-hex character, so errors can
+// be collected with an OR and checked once per call instead of per byte.
+static uint8_t RNCardConnectHexNibbles[256];
+
+static void RNCardConnectHexInitTables(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        static const char digits[] = "0123456789ABCDEF";
+        memset(RNCardConnectHexNibbles, 0x80, sizeof(RNCardConnectHexNibbles));
+        for (int i = 0; i < 16; i++) {
+            RNCardConnectHexNibbles[(uint8_t)digits[i]] = i;
+            RNCardConnectHexNibbles[(uint8_t)tolower(digits[i])] = i;
+        }
+    });
+}
+
+BOOL RNCardConnectHexDecode(const char *hex, size_t length, uint8_t *out)
+{
+    if (length % 2 != 0) {
+        return NO;
+    }
+    RNCardConnectHexInitTables();
+    const uint8_t *input = (const uint8_t *)hex;
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < length / 2; i++) {
+        uint8_t high = RNCardConnectHexNibbles[input[i * 2]];
+        uint8_t low = RNCardConnectHexNibbles[input[i * 2 + 1]];
+        invalid |= high | low;
+        out[i] = (uint8_t)(high << 4 | low);
+    }
+    return (invalid & 0x80) == 0;
+}
+
+NSData *RNCardConnectDataFromHex(id hex)
+{
+    if (![hex isKindOfClass:[NSString class]]) {
+        return nil;
+    }
+    NSString *string = hex;
+    NSUInteger length = string.length;
+    if (length % 2 != 0) {
+        return nil;
+    }
+    NSMutableData *data = [NSMutableData dataWithLength:length / 2];
+
+    // Strings parsed from JSON are usually stored as ASCII already, in which
+    // case their bytes are read in place.
+    const char *characters = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingASCII);
+    if (characters) {
+        return RNCardConnectHexDecode(characters, length, data.mutableBytes) ? data : nil;
+    }
+    char stackBuffer[512];
+    char *buffer = length <= sizeof(stackBuffer) ? stackBuffer : malloc(length);
+    NSUInteger used = 0;
+    BOOL ascii = [string getBytes:buffer
+                        maxLength:length
+                       usedLength:&used
+                         encoding:NSASCIIStringEncoding
+                          options:0
+                            range:NSMakeRange(0, length)
+                   remainingRange:NULL];
+    BOOL valid = ascii && used == length && RNCardConnectHexDecode(buffer, length, data.mutableBytes);
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return valid ? data : nil;
+}
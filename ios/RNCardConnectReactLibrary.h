@@ -1,11 +1,13 @@
 
 #if __has_include("RCTBridgeModule.h")
 #import "RCTBridgeModule.h"
+#import "RCTEventEmitter.h"
 #else
 #import <React/RCTBridgeModule.h>
+#import <React/RCTEventEmitter.h>
 #endif
 
-@interface RNCardConnectReactLibrary : NSObject <RCTBridgeModule>
+@interface RNCardConnectReactLibrary : RCTEventEmitter <RCTBridgeModule>
 
 @end
   
@@ -1,39 +1,841 @@
 
 #import "RNCardConnectReactLibrary.h"
+#import "RNCardConnectAuditLog.h"
+#import "RNCardConnectReaderConfig.h"
+#import "RNCardConnectReaderRegistry.h"
+#import "RNCardConnectRequestLimiter.h"
+#import "RNCardConnectSwiper.h"
+#import "RNCardConnectTokenBatch.h"
+#import "RNCardConnectTokenCache.h"
+#import "RNCardConnectTrace.h"
 #import <CardConnectConsumerSDK/CardConnectConsumerSDK.h>
 #import <CardConnectConsumerSDK/CCCCardInfo.h>
 #import <CardConnectConsumerSDK/CCCAccount.h>
+#import <CardConnectConsumerSDK/CCCCardFunctions.h>
 #import <React/RCTLog.h>
 #import <React/RCTConvert.h>
+#import <QuartzCore/QuartzCore.h>
+
+static NSString *const RNCardConnectErrorInvalidCardNumber = @"E_INVALID_CARD_NUMBER";
+static NSString *const RNCardConnectErrorInvalidCVV = @"E_INVALID_CVV";
+static NSString *const RNCardConnectErrorCancelled = @"E_CANCELLED";
+static NSString *const RNCardConnectErrorQueueFull = @"E_QUEUE_FULL";
+
+// Requests beyond the limiter's current concurrency wait in a queue of at
+// most this many; anything past that is shed with E_QUEUE_FULL.
+static NSUInteger const RNCardConnectMaxQueuedRequests = 256;
+// Rows a getCardTokens batch keeps submitted at once, well inside the queue.
+static NSUInteger const RNCardConnectBatchWindow = 64;
+
+static NSString *const RNCardConnectDefaultLane = @"default";
+
+static NSString *RNCardConnectLane(NSString *lane)
+{
+    return lane.length ? lane : RNCardConnectDefaultLane;
+}
+
+/** YES for a non-empty string made only of decimal digits. */
+static BOOL RNCardConnectIsNumeric(NSString *string)
+{
+    static NSCharacterSet *nonDigits;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        nonDigits = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
+    });
+    return string.length > 0 && [string rangeOfCharacterFromSet:nonDigits].location == NSNotFound;
+}
+
+/**
+ Returns the status code of the first failed check, or nil when the card passes.
+ Safe to call concurrently; the SDK card functions keep no shared state.
+ */
+static NSString *RNCardConnectValidateCard(NSString *cardNumber, NSString *CVV)
+{
+    // CCC_LuhnCheck throws on non-numeric input, so screen it out first.
+    if (!RNCardConnectIsNumeric(cardNumber) || !CCC_ValidateCardNumber(cardNumber)) {
+        return RNCardConnectErrorInvalidCardNumber;
+    }
+    if (CVV == nil || !CCC_ValidateCVV(CVV)) {
+        return RNCardConnectErrorInvalidCVV;
+    }
+    return nil;
+}
+
+/**
+ Every individual SDK check for one card, reported separately so that the
+ two platforms' validators can be compared case by case.
+ */
+typedef struct {
+    CCCCardIssuer issuer;
+    BOOL lengthValid;
+    BOOL cardNumberValid;
+    BOOL cvvValid;
+} RNCardConnectCardCheck;
+
+static RNCardConnectCardCheck RNCardConnectCheckCard(NSString *cardNumber, NSString *CVV)
+{
+    RNCardConnectCardCheck check = {CCCCardIssuerNone, NO, NO, NO};
+    if (RNCardConnectIsNumeric(cardNumber)) {
+        check.issuer = CCC_CardIssuerFromCardNumber(cardNumber);
+        check.lengthValid = CCC_ValidateCardLength(cardNumber);
+        check.cardNumberValid = CCC_ValidateCardNumber(cardNumber);
+    }
+    check.cvvValid = CVV != nil && CCC_ValidateCVV(CVV);
+    return check;
+}
+
+/** BIN and last four, the rest masked; nil for anything that is not a card number. */
+static NSString *RNCardConnectMaskCardNumber(NSString *cardNumber)
+{
+    if (!RNCardConnectIsNumeric(cardNumber) || cardNumber.length < 12) {
+        return nil;
+    }
+    NSUInteger length = cardNumber.length;
+    return [NSString stringWithFormat:@"%@%@%@",
+            [cardNumber substringToIndex:6],
+            [@"" stringByPaddingToLength:length - 10 withString:@"*" startingAtIndex:0],
+            [cardNumber substringFromIndex:length - 4]];
+}
+
+static NSString *RNCardConnectErrorMessage(NSString *code)
+{
+    if ([code isEqualToString:RNCardConnectErrorInvalidCardNumber]) {
+        return @"Invalid CardNumber";
+    }
+    if ([code isEqualToString:RNCardConnectErrorInvalidCVV]) {
+        return @"Invalid CVV";
+    }
+    return @"Invalid card data";
+}
+
+@interface RNCardConnectReactLibrary () <RNCardConnectSwiperDelegate>
+
+// Read from SDK completion threads and the main queue, so kept atomic.
+@property (atomic, strong) RNCardConnectAuditLog *auditLog;
+
+@end
 
 @implementation RNCardConnectReactLibrary
+{
+    dispatch_queue_t _methodQueue;
+    CCCAPI *_api;
+    NSMutableSet<NSURLSessionTask *> *_pendingTasks;
+    RNCardConnectRequestLimiter *_limiter;
+    NSMutableSet<RNCardConnectTokenBatch *> *_batches;
+    // Only created once the app opts in with setTokenCacheEnabled.
+    RNCardConnectTokenCache *_tokenCache;
+
+    // Swiper state is only touched on the main queue.
+    NSMutableDictionary<NSString *, RNCardConnectReaderRegistry *> *_registries;
+    NSMutableDictionary<NSString *, RNCardConnectSwiper *> *_swipers;
+    // Bumped by every connect and release of a lane, so a connect whose config
+    // check finishes after a newer call for the lane is dropped. Method queue only.
+    NSMutableDictionary<NSString *, NSNumber *> *_swiperGenerations;
+    // When each lane's current card read started, for the audit latency.
+    NSMutableDictionary<NSString *, NSNumber *> *_cardReadStartTimes;
+    BOOL _hasListeners;
+}
+
+- (instancetype)init
+{
+    if ((self = [super init])) {
+        // Nothing here touches UIKit; keep validation and request setup off
+        // the main queue. Created once so that internal work dispatched to
+        // methodQueue is serialized with the bridge's calls.
+        _methodQueue = dispatch_queue_create("com.reactcardconnect.sdk", DISPATCH_QUEUE_SERIAL);
+        _pendingTasks = [NSMutableSet new];
+        _batches = [NSMutableSet new];
+        _limiter = [[RNCardConnectRequestLimiter alloc] initWithMaxQueueLength:RNCardConnectMaxQueuedRequests];
+        _registries = [NSMutableDictionary new];
+        _swipers = [NSMutableDictionary new];
+        _swiperGenerations = [NSMutableDictionary new];
+        _cardReadStartTimes = [NSMutableDictionary new];
+    }
+    return self;
+}
+
++ (BOOL)requiresMainQueueSetup
+{
+    // Nothing in init needs UIKit, so let the bridge create the module
+    // lazily on first use instead of on the main thread at launch.
+    return NO;
+}
 
 - (dispatch_queue_t)methodQueue
 {
-    return dispatch_get_main_queue();
+    return _methodQueue;
 }
 
 RCT_EXPORT_MODULE(CardConnect)
 
+- (NSArray<NSString *> *)supportedEvents
+{
+    return @[
+        @"swiperFoundDevices",
+        @"swiperConnectionStateChanged",
+        @"swiperReady",
+        @"swiperReconnecting",
+        @"swiperReconnectFailed",
+        @"swiperDisplayMessage",
+        @"swiperCardReadStarted",
+        @"swiperToken",
+        @"swiperError",
+        @"swiperBatteryStatus",
+        @"swiperConfigurationProgress",
+        @"swiperConfigInvalid",
+        @"tokenizationResult",
+    ];
+}
+
+- (void)startObserving
+{
+    _hasListeners = YES;
+}
+
+- (void)stopObserving
+{
+    _hasListeners = NO;
+}
+
+RCT_EXPORT_METHOD(prepare:(NSDictionary *)options
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSArray<NSString *> *lanes = [RCTConvert NSStringArray:options[@"lanes"]];
+    dispatch_queue_t background = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+
+    // The steps are independent of each other, so each starts at once on
+    // its own queue and the promise resolves when the last one finishes.
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableDictionary<NSString *, NSNumber *> *timings = [NSMutableDictionary new];
+    CFTimeInterval start = CACurrentMediaTime();
+    void (^step)(NSString *, dispatch_queue_t, dispatch_block_t) = ^(NSString *name, dispatch_queue_t queue, dispatch_block_t block) {
+        dispatch_group_async(group, queue, ^{
+            CFTimeInterval stepStart = CACurrentMediaTime();
+            block();
+            double elapsed = (CACurrentMediaTime() - stepStart) * 1000.0;
+            @synchronized (timings) {
+                timings[name] = @(elapsed);
+            }
+        });
+    };
+
+    step(@"api", self.methodQueue, ^{
+        [self api];
+    });
+    step(@"dateFormatter", background, ^{
+        CCC_UTCDateFormatter();
+    });
+    step(@"cardFunctions", background, ^{
+        RNCardConnectValidateCard(@"4111111111111111", @"123");
+    });
+    step(@"readerRegistries", dispatch_get_main_queue(), ^{
+        for (NSString *lane in lanes) {
+            [self readerRegistryForLane:RNCardConnectLane(lane)];
+        }
+    });
+    if (lanes.count) {
+        step(@"readerConfigs", background, ^{
+            [RNCardConnectReaderConfig verifyConfigForSwiperType:CCCSwiperTypeVP3300];
+            [RNCardConnectReaderConfig verifyConfigForSwiperType:CCCSwiperTypeVP3600];
+        });
+    }
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        resolve(@{@"steps": timings, @"total": @((CACurrentMediaTime() - start) * 1000.0)});
+    });
+}
+
 RCT_EXPORT_METHOD(setupConsumerApiEndpoint:(NSString *)endpoint) {
-    [CCCAPI instance].endpoint = endpoint;
+    [self api].endpoint = endpoint;
 }
 
 RCT_EXPORT_METHOD(getCardToken:(NSString *)cardNumber expirationDate:(NSString *)expirationDate CVV:(NSString *)CVV                   resolve: (RCTPromiseResolveBlock)resolve
 rejecter:(RCTPromiseRejectBlock)reject)
 {
+    [self requestTokenForCardNumber:cardNumber expirationDate:expirationDate CVV:CVV priority:RNCardConnectRequestPriorityInteractive resolve:resolve reject:reject];
+}
+
+RCT_EXPORT_METHOD(getCardTokenWithOptions:(NSString *)cardNumber
+                  expirationDate:(NSString *)expirationDate
+                  CVV:(NSString *)CVV
+                  options:(NSDictionary *)options
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    RNCardConnectRequestPriority priority = [[RCTConvert NSString:options[@"priority"]] isEqualToString:@"background"]
+        ? RNCardConnectRequestPriorityBackground
+        : RNCardConnectRequestPriorityInteractive;
+    [self requestTokenForCardNumber:cardNumber expirationDate:expirationDate CVV:CVV priority:priority resolve:resolve reject:reject];
+}
+
+- (void)requestTokenForCardNumber:(NSString *)cardNumber
+                   expirationDate:(NSString *)expirationDate
+                              CVV:(NSString *)CVV
+                         priority:(RNCardConnectRequestPriority)priority
+                          resolve:(RCTPromiseResolveBlock)resolve
+                           reject:(RCTPromiseRejectBlock)reject
+{
+    uint64_t traceStart = RNCardConnectTraceBegin();
+    uint64_t flow = traceStart ? RNCardConnectTraceNextFlow() : 0;
+    if (traceStart) {
+        RCTPromiseResolveBlock innerResolve = resolve;
+        RCTPromiseRejectBlock innerReject = reject;
+        resolve = ^(id token) {
+            RNCardConnectTraceEnd("getCardToken", traceStart, flow);
+            RNCardConnectTraceInstant("resolve", flow);
+            innerResolve(token);
+        };
+        reject = ^(NSString *code, NSString *message, NSError *error) {
+            RNCardConnectTraceEnd("getCardToken", traceStart, flow);
+            RNCardConnectTraceInstant("reject", flow);
+            innerReject(code, message, error);
+        };
+    }
+
+    RNCardConnectAuditLog *auditLog = self.auditLog;
+    if (auditLog) {
+        CFTimeInterval start = CACurrentMediaTime();
+        NSString *maskedCardNumber = RNCardConnectMaskCardNumber(cardNumber);
+        NSString *issuer = RNCardConnectIsNumeric(cardNumber) ? CCC_AccountTypeForIssuer(CCC_CardIssuerFromCardNumber(cardNumber)) : nil;
+        RCTPromiseResolveBlock innerResolve = resolve;
+        RCTPromiseRejectBlock innerReject = reject;
+        resolve = ^(id token) {
+            [auditLog recordKind:RNCardConnectAuditKindToken maskedCardNumber:maskedCardNumber token:token issuer:issuer code:nil latency:(CACurrentMediaTime() - start) * 1000];
+            innerResolve(token);
+        };
+        reject = ^(NSString *code, NSString *message, NSError *error) {
+            [auditLog recordKind:RNCardConnectAuditKindToken maskedCardNumber:maskedCardNumber token:nil issuer:issuer code:code latency:(CACurrentMediaTime() - start) * 1000];
+            innerReject(code, message, error);
+        };
+    }
+
+    NSString *validationError = RNCardConnectValidateCard(cardNumber, CVV);
+    if (validationError) {
+        reject(validationError, RNCardConnectErrorMessage(validationError), nil);
+        return;
+    }
+
+    RNCardConnectTokenCache *tokenCache = _tokenCache;
+    NSData *cacheKey = [tokenCache keyForCardNumber:cardNumber expirationDate:expirationDate CVV:CVV];
+    NSString *cachedToken = [tokenCache tokenForKey:cacheKey];
+    if (cachedToken) {
+        resolve(cachedToken);
+        return;
+    }
+
     CCCCardInfo *card = [CCCCardInfo new];
     card.cardNumber = cardNumber;
     card.expirationDate = expirationDate;
     card.CVV = CVV;
 
-    [[CCCAPI instance] generateAccountForCard:card completion:^(CCCAccount *account, NSError *error){
-        if (account) {
-            resolve(account.token);
-        } else {
-            reject(@"error", error.localizedDescription, error);
+    CCCAPI *api = [self api];
+    BOOL accepted = [_limiter enqueue:^(RNCardConnectLimiterDone done) {
+        RNCardConnectTraceEnd("limiterWait", traceStart, flow);
+        [self generateTokenForCard:card api:api priority:priority flow:flow tokenCache:tokenCache cacheKey:cacheKey resolve:resolve reject:reject done:done];
+    } priority:priority cancel:^{
+        reject(RNCardConnectErrorCancelled, @"Request cancelled", nil);
+    }];
+    if (!accepted) {
+        reject(RNCardConnectErrorQueueFull, @"Too many tokenization requests pending", nil);
+    }
+}
+
+RCT_EXPORT_METHOD(getCardTokens:(NSArray<NSDictionary *> *)cards
+                  options:(NSDictionary *)options
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSString *batchId = [RCTConvert NSString:options[@"batchId"]];
+    NSUInteger startIndex = MIN((NSUInteger)MAX([RCTConvert NSInteger:options[@"startIndex"]], 0), cards.count);
+    RNCardConnectRequestPriority priority = [[RCTConvert NSString:options[@"priority"]] isEqualToString:@"interactive"]
+        ? RNCardConnectRequestPriorityInteractive
+        : RNCardConnectRequestPriorityBackground;
+
+    __weak __typeof(self) weakSelf = self;
+    dispatch_queue_t methodQueue = _methodQueue;
+    __block __weak RNCardConnectTokenBatch *weakBatch = nil;
+    RNCardConnectTokenBatch *batch = [[RNCardConnectTokenBatch alloc] initWithRange:NSMakeRange(startIndex, cards.count - startIndex)
+                                                                             window:RNCardConnectBatchWindow
+                                                                             submit:^(NSUInteger index, RNCardConnectBatchRowDone done) {
+        // Rows after the first window are submitted from whichever thread
+        // settled the previous row; requests are only set up on the method
+        // queue, like those coming from the bridge.
+        dispatch_async(methodQueue, ^{
+            // cancelPendingRequests may have run while this row was waiting.
+            if (weakBatch.stopped) {
+                done(nil);
+                return;
+            }
+            NSDictionary *card = [RCTConvert NSDictionary:cards[index]];
+            NSString *cardNumber = [RCTConvert NSString:card[@"cardNumber"]];
+            NSMutableDictionary *result = [NSMutableDictionary new];
+            result[@"maskedCardNumber"] = RNCardConnectMaskCardNumber(cardNumber);
+            if (RNCardConnectIsNumeric(cardNumber)) {
+                result[@"issuer"] = CCC_AccountTypeForIssuer(CCC_CardIssuerFromCardNumber(cardNumber));
+            }
+
+            [weakSelf requestTokenForCardNumber:cardNumber
+                                 expirationDate:[RCTConvert NSString:card[@"expiryDate"]]
+                                            CVV:[RCTConvert NSString:card[@"cvv"]]
+                                       priority:priority
+                                        resolve:^(id token) {
+                result[@"token"] = token;
+                done(result);
+            } reject:^(NSString *code, NSString *message, NSError *error) {
+                if ([code isEqualToString:RNCardConnectErrorCancelled]) {
+                    done(nil);
+                    return;
+                }
+                result[@"code"] = code;
+                result[@"message"] = message;
+                done(result);
+            }];
+        });
+    }];
+    weakBatch = batch;
+    batch.rowHandler = ^(NSUInteger index, NSDictionary *result, NSUInteger checkpoint) {
+        NSMutableDictionary *body = [result mutableCopy];
+        body[@"batchId"] = batchId;
+        body[@"index"] = @(index);
+        body[@"checkpoint"] = @(checkpoint);
+        [weakSelf sendTokenizationEvent:body];
+    };
+
+    @synchronized (_batches) {
+        [_batches addObject:batch];
+    }
+    [batch runWithCompletion:^(NSUInteger succeeded, NSUInteger failed, NSUInteger checkpoint) {
+        __typeof(self) strongSelf = weakSelf;
+        if (strongSelf) {
+            @synchronized (strongSelf->_batches) {
+                [strongSelf->_batches removeObject:batch];
+            }
         }
+        resolve(@{
+            @"succeeded": @(succeeded),
+            @"failed": @(failed),
+            @"checkpoint": @(checkpoint),
+            @"complete": @(checkpoint == cards.count),
+        });
     }];
 }
 
+RCT_EXPORT_METHOD(setTokenCacheEnabled:(BOOL)enabled ttl:(double)ttl)
+{
+    if (!enabled) {
+        [_tokenCache clear];
+        _tokenCache = nil;
+        [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                        name:UIApplicationDidEnterBackgroundNotification
+                                                      object:nil];
+        return;
+    }
+    if (!_tokenCache) {
+        _tokenCache = [RNCardConnectTokenCache new];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+    }
+    _tokenCache.ttl = ttl;
+}
+
+RCT_EXPORT_METHOD(clearTokenCache)
+{
+    [_tokenCache clear];
+}
+
+RCT_EXPORT_METHOD(validateCards:(NSArray<NSDictionary *> *)cards
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSUInteger count = cards.count;
+    RNCardConnectCardCheck *checks = calloc(count, sizeof(RNCardConnectCardCheck));
+
+    // dispatch_apply spreads the iterations over the available cores and
+    // balances them between worker threads as they finish.
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        NSDictionary *card = [RCTConvert NSDictionary:cards[i]];
+        checks[i] = RNCardConnectCheckCard([RCTConvert NSString:card[@"cardNumber"]],
+                                           [RCTConvert NSString:card[@"cvv"]]);
+    });
+
+    NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        RNCardConnectCardCheck check = checks[i];
+        NSString *code = !check.cardNumberValid ? RNCardConnectErrorInvalidCardNumber
+            : !check.cvvValid ? RNCardConnectErrorInvalidCVV
+            : nil;
+        [results addObject:@{
+            @"valid": @(code == nil),
+            @"code": code ?: [NSNull null],
+            @"issuer": CCC_AccountTypeForIssuer(check.issuer) ?: [NSNull null],
+            @"lengthValid": @(check.lengthValid),
+            @"cardNumberValid": @(check.cardNumberValid),
+            @"cvvValid": @(check.cvvValid),
+        }];
+    }
+    free(checks);
+
+    resolve(results);
+}
+
+RCT_EXPORT_METHOD(setAuditLogEnabled:(BOOL)enabled
+                  options:(NSDictionary *)options)
+{
+    RNCardConnectAuditLog *previous = self.auditLog;
+    self.auditLog = nil;
+    [previous closeWithCompletion:nil];
+    if (!enabled) {
+        return;
+    }
+
+    NSString *directory = [RCTConvert NSString:options[@"directory"]];
+    if (!directory.length) {
+        NSString *support = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES).firstObject;
+        directory = [support stringByAppendingPathComponent:@"RNCardConnectAudit"];
+    }
+    NSString *sync = [RCTConvert NSString:options[@"sync"]];
+    double maxSegmentBytes = [RCTConvert double:options[@"maxSegmentBytes"]];
+    NSInteger maxSegments = [RCTConvert NSInteger:options[@"maxSegments"]];
+    self.auditLog = [[RNCardConnectAuditLog alloc] initWithDirectory:directory
+                                                     maxSegmentBytes:maxSegmentBytes > 0 ? (unsigned long long)maxSegmentBytes : 1024 * 1024
+                                                         maxSegments:maxSegments > 0 ? maxSegments : 8
+                                                                sync:[sync isEqualToString:@"batch"] ? RNCardConnectAuditSyncBatch
+                                                                     : [sync isEqualToString:@"never"] ? RNCardConnectAuditSyncNever
+                                                                     : RNCardConnectAuditSyncSegment];
+}
+
+RCT_EXPORT_METHOD(getAuditLogStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([self.auditLog stats] ?: [NSNull null]);
+}
+
+RCT_EXPORT_METHOD(setTracingEnabled:(BOOL)enabled)
+{
+    RNCardConnectTraceSetEnabled(enabled);
+}
+
+RCT_EXPORT_METHOD(exportTrace:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSUInteger dropped = 0;
+    NSDictionary *trace = RNCardConnectTraceExport(&dropped);
+    NSString *name = [NSString stringWithFormat:@"cardconnect-trace-%.0f.json", [NSDate date].timeIntervalSince1970 * 1000];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+    NSError *error;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:trace options:0 error:&error];
+    if (!data || ![data writeToFile:path options:NSDataWritingAtomic error:&error]) {
+        reject(@"error", error.localizedDescription, error);
+        return;
+    }
+    resolve(@{
+        @"path": path,
+        @"events": @([trace[@"traceEvents"] count]),
+        @"dropped": @(dropped),
+    });
+}
+
+RCT_EXPORT_METHOD(getRequestStats:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    resolve([_limiter stats]);
+}
+
+RCT_EXPORT_METHOD(cancelPendingRequests)
+{
+    NSArray<RNCardConnectTokenBatch *> *batches;
+    @synchronized (_batches) {
+        batches = [_batches allObjects];
+    }
+    for (RNCardConnectTokenBatch *batch in batches) {
+        [batch stop];
+    }
+    [_limiter cancelQueued];
+
+    NSArray<NSURLSessionTask *> *tasks;
+    @synchronized (_pendingTasks) {
+        tasks = [_pendingTasks allObjects];
+        [_pendingTasks removeAllObjects];
+    }
+    for (NSURLSessionTask *task in tasks) {
+        [task cancel];
+    }
+}
+
+#pragma mark - Swiper
+
+// Each lane owns one reader with its own controller, registry and pending
+// restart completion. Single-reader apps can use any fixed lane name.
+
+RCT_EXPORT_METHOD(connectSwiper:(NSDictionary *)options)
+{
+    NSString *lane = RNCardConnectLane([RCTConvert NSString:options[@"lane"]]);
+    CCCSwiperType type = [[RCTConvert NSString:options[@"type"]] isEqualToString:@"VP3600"]
+        ? CCCSwiperTypeVP3600
+        : CCCSwiperTypeVP3300;
+    CCCCardReadMode mode = [[RCTConvert NSString:options[@"mode"]] isEqualToString:@"swipe"]
+        ? CCCCardReadModeSwipe
+        : CCCCardReadModeSwipeDip;
+    BOOL continuous = [RCTConvert BOOL:options[@"continuous"]];
+
+    // The first check per launch hashes every CAPK, so it runs off the method
+    // queue; the connect then resumes here, unless a later connect or release
+    // for the lane came in meanwhile.
+    NSUInteger generation = [self bumpSwiperGenerationForLane:lane];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSDictionary *config = [RNCardConnectReaderConfig verifyConfigForSwiperType:type];
+        dispatch_async(self->_methodQueue, ^{
+            if ([self->_swiperGenerations[lane] unsignedIntegerValue] != generation) {
+                return;
+            }
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self->_swipers[lane] releaseDevice];
+                if (![config[@"valid"] boolValue]) {
+                    [self->_swipers removeObjectForKey:lane];
+                    if (self->_hasListeners) {
+                        [self sendEventWithName:@"swiperConfigInvalid" body:@{@"lane": lane, @"failures": config[@"failures"]}];
+                    }
+                    return;
+                }
+                RNCardConnectSwiper *swiper = [[RNCardConnectSwiper alloc] initWithLane:lane
+                                                                                   type:type
+                                                                                   mode:mode
+                                                                             continuous:continuous
+                                                                               registry:[self readerRegistryForLane:lane]
+                                                                               delegate:self];
+                self->_swipers[lane] = swiper;
+                [swiper connect];
+            });
+        });
+    });
+}
+
+RCT_EXPORT_METHOD(verifyReaderConfig:(NSString *)typeName
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    CCCSwiperType type = [typeName isEqualToString:@"VP3600"] ? CCCSwiperTypeVP3600 : CCCSwiperTypeVP3300;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        resolve([RNCardConnectReaderConfig verifyConfigForSwiperType:type]);
+    });
+}
+
+RCT_EXPORT_METHOD(connectSwiperDevice:(NSString *)laneName uuid:(NSString *)uuid)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    NSUUID *deviceUUID = [[NSUUID alloc] initWithUUIDString:uuid];
+    if (!deviceUUID) {
+        return;
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_swipers[lane] connectToDevice:deviceUUID];
+    });
+}
+
+RCT_EXPORT_METHOD(restartSwiper:(NSString *)laneName)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_swipers[lane] restart];
+    });
+}
+
+RCT_EXPORT_METHOD(cancelSwiperTransaction:(NSString *)laneName)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_swipers[lane] cancelTransaction];
+    });
+}
+
+RCT_EXPORT_METHOD(releaseSwiper:(NSString *)laneName)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    [self bumpSwiperGenerationForLane:lane];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_swipers[lane] releaseDevice];
+        [self->_swipers removeObjectForKey:lane];
+    });
+}
+
+RCT_EXPORT_METHOD(getKnownReaders:(NSString *)laneName
+                  resolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    dispatch_async(dispatch_get_main_queue(), ^{
+        resolve([[self readerRegistryForLane:lane] knownDevices]);
+    });
+}
+
+RCT_EXPORT_METHOD(forgetReader:(NSString *)laneName uuid:(NSString *)uuid)
+{
+    NSString *lane = RNCardConnectLane(laneName);
+    NSUUID *deviceUUID = [[NSUUID alloc] initWithUUIDString:uuid];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[self readerRegistryForLane:lane] forgetDevice:deviceUUID];
+    });
+}
+
+- (RNCardConnectReaderRegistry *)readerRegistryForLane:(NSString *)lane
+{
+    RNCardConnectReaderRegistry *registry = _registries[lane];
+    if (!registry) {
+        NSString *key = [@"RNCardConnectReaderRegistry." stringByAppendingString:lane];
+        registry = [[RNCardConnectReaderRegistry alloc] initWithKey:key];
+        _registries[lane] = registry;
+    }
+    return registry;
+}
+
+- (BOOL)swiper:(RNCardConnectSwiper *)swiper canUseDevice:(NSUUID *)uuid
+{
+    for (RNCardConnectSwiper *other in _swipers.allValues) {
+        if (other != swiper && [other.deviceUUID isEqual:uuid]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (void)swiper:(RNCardConnectSwiper *)swiper sendEvent:(NSString *)name body:(NSDictionary *)body
+{
+    [self auditSwiper:swiper event:name body:body];
+    if (_hasListeners) {
+        NSMutableDictionary *laneBody = [body mutableCopy];
+        laneBody[@"lane"] = swiper.lane;
+        [self sendEventWithName:name body:laneBody];
+    }
+}
+
+- (void)invalidate
+{
+    [super invalidate];
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [self.auditLog closeWithCompletion:nil];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        for (RNCardConnectSwiper *swiper in self->_swipers.allValues) {
+            [swiper releaseDevice];
+        }
+        [self->_swipers removeAllObjects];
+    });
+}
+
+#pragma mark - Private
+
+/** Method queue only. */
+- (NSUInteger)bumpSwiperGenerationForLane:(NSString *)lane
+{
+    NSUInteger generation = [_swiperGenerations[lane] unsignedIntegerValue] + 1;
+    _swiperGenerations[lane] = @(generation);
+    return generation;
+}
+
+/** Main queue, like the rest of the swiper state. */
+- (void)auditSwiper:(RNCardConnectSwiper *)swiper event:(NSString *)name body:(NSDictionary *)body
+{
+    if ([name isEqualToString:@"swiperCardReadStarted"]) {
+        _cardReadStartTimes[swiper.lane] = @(CACurrentMediaTime());
+        return;
+    }
+    BOOL token = [name isEqualToString:@"swiperToken"];
+    if (!token && ![name isEqualToString:@"swiperError"]) {
+        return;
+    }
+
+    NSNumber *start = _cardReadStartTimes[swiper.lane];
+    [_cardReadStartTimes removeObjectForKey:swiper.lane];
+    RNCardConnectAuditLog *auditLog = self.auditLog;
+    if (!auditLog) {
+        return;
+    }
+    NSString *last4 = [RCTConvert NSString:body[@"last4"]];
+    [auditLog recordKind:RNCardConnectAuditKindSwipe
+        maskedCardNumber:last4 ? [@"************" stringByAppendingString:last4] : nil
+                   token:[RCTConvert NSString:body[@"token"]]
+                  issuer:[RCTConvert NSString:body[@"accountType"]]
+                    code:token ? nil : [body[@"code"] description]
+                 latency:start ? (CACurrentMediaTime() - start.doubleValue) * 1000 : -1];
+}
+
+- (void)generateTokenForCard:(CCCCardInfo *)card
+                         api:(CCCAPI *)api
+                    priority:(RNCardConnectRequestPriority)priority
+                        flow:(uint64_t)flow
+                  tokenCache:(RNCardConnectTokenCache *)tokenCache
+                    cacheKey:(NSData *)cacheKey
+                     resolve:(RCTPromiseResolveBlock)resolve
+                      reject:(RCTPromiseRejectBlock)reject
+                        done:(RNCardConnectLimiterDone)done
+{
+    // The completion may run on any queue, so the pending set is only
+    // touched under its own lock. A completion that fires before we get to
+    // record the task leaves it in the completed state and it is skipped.
+    uint64_t networkStart = RNCardConnectTraceBegin();
+    @synchronized (_pendingTasks) {
+        __block NSURLSessionTask *task = [api generateAccountForCard:card completion:^(CCCAccount *account, NSError *error){
+            RNCardConnectTraceEnd("network", networkStart, flow);
+            [self removePendingTask:task];
+            task = nil;
+
+            // Drop the card data as soon as the request settles rather than
+            // whenever the SDK happens to release its copy of the card.
+            card.cardNumber = nil;
+            card.CVV = nil;
+
+            if (account) {
+                done(RNCardConnectLimiterOutcomeSuccess);
+                [tokenCache setToken:account.token forKey:cacheKey];
+                resolve(account.token);
+            } else if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
+                done(RNCardConnectLimiterOutcomeDropped);
+                reject(RNCardConnectErrorCancelled, @"Request cancelled", error);
+            } else {
+                done(RNCardConnectLimiterOutcomeFailure);
+                reject(@"error", error.localizedDescription, error);
+            }
+        }];
+        if (task && task.state != NSURLSessionTaskStateCompleted) {
+            task.priority = priority == RNCardConnectRequestPriorityBackground ? NSURLSessionTaskPriorityLow : NSURLSessionTaskPriorityHigh;
+            [_pendingTasks addObject:task];
+        }
+    }
+}
+
+- (void)sendTokenizationEvent:(NSDictionary *)body
+{
+    if (_hasListeners) {
+        [self sendEventWithName:@"tokenizationResult" body:body];
+    }
+}
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    dispatch_async(self.methodQueue, ^{
+        [self->_tokenCache clear];
+    });
+}
+
+// Resolved on first use so that loading the SDK's API singleton stays out of
+// app launch. Only called on the method queue.
+- (CCCAPI *)api
+{
+    if (!_api) {
+        _api = [CCCAPI instance];
+    }
+    return _api;
+}
+
+- (void)removePendingTask:(NSURLSessionTask *)task
+{
+    if (!task) {
+        return;
+    }
+    @synchronized (_pendingTasks) {
+        [_pendingTasks removeObject:task];
+    }
+}
+
 @end
@@ -0,0 +1,20 @@
+#import <Foundation/Foundation.h>
+#import <CardConnectConsumerSDK/CCCSwiperController.h>
+
+/**
+ Checks the VP3300Config / VP3600Config file the SDK installs on a reader
+ before a connect gets anywhere near the device. Every CAPK's SHA-1 check
+ value is recomputed from its RID, index, modulus and exponent, and the
+ hex fields are validated. A config that passes is remembered in
+ NSUserDefaults under its version, size and modification date, so later
+ launches skip the hashing. Thread safe.
+ */
+@interface RNCardConnectReaderConfig : NSObject
+
+/**
+ A JS friendly result: valid, cached, version, capks (entries checked),
+ failures (one message per problem found) and time in milliseconds.
+ */
++ (NSDictionary *)verifyConfigForSwiperType:(CCCSwiperType)type;
+
+@end
@@ -0,0 +1,188 @@
+#import "RNCardConnectReaderConfig.h"
+#import "RNCardConnectHex.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <QuartzCore/QuartzCore.h>
+
+static NSString *const RNCardConnectVerifiedConfigsKey = @"RNCardConnectVerifiedReaderConfigs";
+
+// EMV Book 2 only defines SHA-1 for CAPK check values.
+static NSString *const RNCardConnectCAPKHashSHA1 = @"01";
+
+/**
+ Checks one CAPK entry; returns NULL when it is intact or a static
+ description of the first problem.
+ */
+static const char *RNCardConnectCheckCAPK(NSDictionary *capk)
+{
+    if (![capk isKindOfClass:[NSDictionary class]]) {
+        return "not an object";
+    }
+    // name is the five byte RID followed by the one byte key index.
+    NSData *name = RNCardConnectDataFromHex(capk[@"name"]);
+    NSData *modulus = RNCardConnectDataFromHex(capk[@"modulus"]);
+    NSData *exponent = RNCardConnectDataFromHex(capk[@"exponent"]);
+    NSData *expected = RNCardConnectDataFromHex(capk[@"hash_value"]);
+    if (name.length != 6 || modulus.length == 0 || exponent.length == 0 || expected.length != CC_SHA1_DIGEST_LENGTH) {
+        return "malformed hex field";
+    }
+    if (![capk[@"hash_algorithm"] isEqual:RNCardConnectCAPKHashSHA1]) {
+        return "unsupported hash algorithm";
+    }
+
+    // modulus_length is a little-endian byte count.
+    NSData *modulusLength = RNCardConnectDataFromHex(capk[@"modulus_length"]);
+    if (capk[@"modulus_length"] && modulusLength.length == 0) {
+        return "malformed hex field";
+    }
+    if (modulusLength) {
+        const uint8_t *bytes = modulusLength.bytes;
+        NSUInteger declared = 0;
+        for (NSUInteger i = modulusLength.length; i > 0; i--) {
+            declared = declared << 8 | bytes[i - 1];
+        }
+        if (declared != modulus.length) {
+            return "modulus length mismatch";
+        }
+    }
+
+    // The exponent is stored zero-padded but hashed without the padding.
+    const uint8_t *exponentBytes = exponent.bytes;
+    NSUInteger exponentStart = 0;
+    while (exponentStart + 1 < exponent.length && exponentBytes[exponentStart] == 0) {
+        exponentStart++;
+    }
+
+    CC_SHA1_CTX context;
+    CC_SHA1_Init(&context);
+    CC_SHA1_Update(&context, name.bytes, (CC_LONG)name.length);
+    CC_SHA1_Update(&context, modulus.bytes, (CC_LONG)modulus.length);
+    CC_SHA1_Update(&context, exponentBytes + exponentStart, (CC_LONG)(exponent.length - exponentStart));
+    uint8_t digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1_Final(digest, &context);
+    return memcmp(digest, expected.bytes, CC_SHA1_DIGEST_LENGTH) == 0 ? NULL : "hash mismatch";
+}
+
+static void RNCardConnectCheckSection(NSDictionary *section, NSString *sectionName, NSMutableArray<NSString *> *failures)
+{
+    if (![section isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+    NSDictionary *terminal = section[@"terminal"];
+    if ([terminal isKindOfClass:[NSDictionary class]]) {
+        if (!RNCardConnectDataFromHex(terminal[@"data"])) {
+            [failures addObject:[NSString stringWithFormat:@"%@ terminal: malformed data", sectionName]];
+        }
+        // The checksum algorithm is not published, so only its shape is checked.
+        if (terminal[@"checksum"] && RNCardConnectDataFromHex(terminal[@"checksum"]).length != CC_SHA1_DIGEST_LENGTH) {
+            [failures addObject:[NSString stringWithFormat:@"%@ terminal: malformed checksum", sectionName]];
+        }
+    }
+    NSArray *aids = section[@"aid"];
+    if ([aids isKindOfClass:[NSArray class]]) {
+        for (NSDictionary *aid in aids) {
+            if (![aid isKindOfClass:[NSDictionary class]] || !RNCardConnectDataFromHex(aid[@"name"]) || !RNCardConnectDataFromHex(aid[@"value"])) {
+                [failures addObject:[NSString stringWithFormat:@"%@ aid: malformed entry", sectionName]];
+            }
+        }
+    }
+}
+
+@implementation RNCardConnectReaderConfig
+
++ (NSURL *)URLForSwiperType:(CCCSwiperType)type
+{
+    // The configs ship at the root of the SDK framework.
+    NSBundle *bundle = [NSBundle bundleForClass:[CCCSwiperController class]];
+    NSString *name = type == CCCSwiperTypeVP3600 ? @"VP3600Config" : @"VP3300Config";
+    return [bundle URLForResource:name withExtension:nil];
+}
+
++ (NSDictionary *)verifyConfigForSwiperType:(CCCSwiperType)type
+{
+    static NSMutableDictionary<NSNumber *, NSDictionary *> *verified;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        verified = [NSMutableDictionary new];
+    });
+    @synchronized (verified) {
+        NSDictionary *result = verified[@(type)];
+        if (!result) {
+            result = [self verifyConfigAtURL:[self URLForSwiperType:type]];
+            // A failed check is repeated next time in case the file was being replaced.
+            if ([result[@"valid"] boolValue]) {
+                verified[@(type)] = result;
+            }
+        }
+        return result;
+    }
+}
+
++ (NSDictionary *)verifyConfigAtURL:(NSURL *)url
+{
+    CFTimeInterval start = CACurrentMediaTime();
+    NSDictionary *(^finish)(BOOL, BOOL, id, NSUInteger, NSArray *) = ^(BOOL valid, BOOL cached, id version, NSUInteger capks, NSArray *failures) {
+        return @{
+            @"valid": @(valid),
+            @"cached": @(cached),
+            @"version": version ?: [NSNull null],
+            @"capks": @(capks),
+            @"failures": failures,
+            @"time": @((CACurrentMediaTime() - start) * 1000),
+        };
+    };
+
+    NSDictionary *attributes = url ? [[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:nil] : nil;
+    NSData *data = attributes ? [NSData dataWithContentsOfURL:url] : nil;
+    NSDictionary *config = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    if (![config isKindOfClass:[NSDictionary class]]) {
+        return finish(NO, NO, nil, 0, @[@"config missing or not JSON"]);
+    }
+
+    NSDictionary *meta = config[@"config_meta"];
+    id version = [meta isKindOfClass:[NSDictionary class]] ? meta[@"version"] : nil;
+    // Bundled files never change in place, so a version that verified with
+    // the same size and modification date still holds.
+    NSString *cacheKey = [NSString stringWithFormat:@"%@:%llu:%.0f",
+                          version, attributes.fileSize, attributes.fileModificationDate.timeIntervalSince1970];
+    NSString *fileName = url.lastPathComponent;
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    if ([[defaults dictionaryForKey:RNCardConnectVerifiedConfigsKey][fileName] isEqual:cacheKey]) {
+        return finish(YES, YES, version, 0, @[]);
+    }
+
+    NSMutableArray<NSString *> *failures = [NSMutableArray new];
+    NSMutableArray<NSDictionary *> *capks = [NSMutableArray new];
+    for (NSString *sectionName in @[@"contact", @"contactless"]) {
+        NSDictionary *section = config[sectionName];
+        RNCardConnectCheckSection(section, sectionName, failures);
+        NSArray *sectionCAPKs = [section isKindOfClass:[NSDictionary class]] ? section[@"capk"] : nil;
+        if ([sectionCAPKs isKindOfClass:[NSArray class]]) {
+            [capks addObjectsFromArray:sectionCAPKs];
+        }
+    }
+
+    // Entries are independent, so they are hashed concurrently; each slot is
+    // written by exactly one iteration.
+    NSUInteger count = capks.count;
+    const char **problems = calloc(MAX(count, 1), sizeof(const char *));
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        problems[i] = RNCardConnectCheckCAPK(capks[i]);
+    });
+    for (NSUInteger i = 0; i < count; i++) {
+        if (problems[i]) {
+            id name = [capks[i] isKindOfClass:[NSDictionary class]] ? capks[i][@"name"] : nil;
+            [failures addObject:[NSString stringWithFormat:@"capk %@: %s", name ?: @(i), problems[i]]];
+        }
+    }
+    free(problems);
+
+    BOOL valid = failures.count == 0;
+    if (valid) {
+        NSMutableDictionary *stored = [[defaults dictionaryForKey:RNCardConnectVerifiedConfigsKey] mutableCopy] ?: [NSMutableDictionary new];
+        stored[fileName] = cacheKey;
+        [defaults setObject:stored forKey:RNCardConnectVerifiedConfigsKey];
+    }
+    return finish(valid, NO, version, count, failures);
+}
+
+@end
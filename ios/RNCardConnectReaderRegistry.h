@@ -0,0 +1,35 @@
+
+#import <Foundation/Foundation.h>
+
+@class CCCDevice;
+
+/**
+ Remembers the readers this app has connected to so a lane can reconnect to
+ its reader directly on launch instead of waiting for a discovery scan.
+ Entries are persisted in NSUserDefaults. Not thread safe; use it from the
+ swiper's queue.
+ */
+@interface RNCardConnectReaderRegistry : NSObject
+
+- (instancetype)initWithKey:(NSString *)key;
+
+/** The reader that most recently reached the connected state, if any. */
+- (NSUUID *)preferredDeviceUUID;
+
+/**
+ Orders discovered devices for connection: known readers first, by their
+ last successful connection, followed by unknown readers in scan order.
+ */
+- (NSArray<CCCDevice *> *)rankDevices:(NSArray<CCCDevice *> *)devices;
+
+- (BOOL)isKnownDevice:(NSUUID *)uuid;
+
+- (void)recordSeenDevice:(CCCDevice *)device;
+- (void)recordConnectedDevice:(NSUUID *)uuid;
+- (void)recordFailedDevice:(NSUUID *)uuid;
+- (void)forgetDevice:(NSUUID *)uuid;
+
+/** A JS friendly snapshot of all known readers. */
+- (NSArray<NSDictionary *> *)knownDevices;
+
+@end
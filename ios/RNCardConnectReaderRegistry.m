@@ -0,0 +1,144 @@
+
+#import "RNCardConnectReaderRegistry.h"
+#import <CardConnectConsumerSDK/CCCDevice.h>
+
+static NSString *const RNCardConnectReaderName = @"name";
+static NSString *const RNCardConnectReaderLastSeen = @"lastSeen";
+static NSString *const RNCardConnectReaderLastConnected = @"lastConnected";
+static NSString *const RNCardConnectReaderFailures = @"failures";
+
+// A reader that keeps failing direct reconnects is dropped as the preferred
+// device so launch goes straight to a scan instead.
+static NSInteger const RNCardConnectReaderMaxFailures = 3;
+
+@implementation RNCardConnectReaderRegistry
+{
+    NSString *_key;
+    NSMutableDictionary<NSString *, NSMutableDictionary *> *_devices;
+}
+
+- (instancetype)initWithKey:(NSString *)key
+{
+    if ((self = [super init])) {
+        _key = [key copy];
+        _devices = [NSMutableDictionary new];
+        NSDictionary *stored = [[NSUserDefaults standardUserDefaults] dictionaryForKey:key];
+        [stored enumerateKeysAndObjectsUsingBlock:^(NSString *uuid, NSDictionary *entry, BOOL *stop) {
+            if ([entry isKindOfClass:[NSDictionary class]]) {
+                self->_devices[uuid] = [entry mutableCopy];
+            }
+        }];
+    }
+    return self;
+}
+
+- (NSUUID *)preferredDeviceUUID
+{
+    NSString *preferred = nil;
+    double latest = 0;
+    for (NSString *uuid in _devices) {
+        NSDictionary *entry = _devices[uuid];
+        double connected = [entry[RNCardConnectReaderLastConnected] doubleValue];
+        if (connected > latest && [entry[RNCardConnectReaderFailures] integerValue] < RNCardConnectReaderMaxFailures) {
+            latest = connected;
+            preferred = uuid;
+        }
+    }
+    return preferred ? [[NSUUID alloc] initWithUUIDString:preferred] : nil;
+}
+
+- (NSArray<CCCDevice *> *)rankDevices:(NSArray<CCCDevice *> *)devices
+{
+    NSMutableArray<CCCDevice *> *known = [NSMutableArray new];
+    NSMutableArray<CCCDevice *> *unknown = [NSMutableArray new];
+    for (CCCDevice *device in devices) {
+        if ([self isKnownDevice:device.uuid]) {
+            [known addObject:device];
+        } else {
+            [unknown addObject:device];
+        }
+    }
+    [known sortUsingComparator:^NSComparisonResult(CCCDevice *a, CCCDevice *b) {
+        double aConnected = [self->_devices[a.uuid.UUIDString][RNCardConnectReaderLastConnected] doubleValue];
+        double bConnected = [self->_devices[b.uuid.UUIDString][RNCardConnectReaderLastConnected] doubleValue];
+        if (aConnected == bConnected) {
+            return NSOrderedSame;
+        }
+        return aConnected > bConnected ? NSOrderedAscending : NSOrderedDescending;
+    }];
+    return [known arrayByAddingObjectsFromArray:unknown];
+}
+
+- (BOOL)isKnownDevice:(NSUUID *)uuid
+{
+    return uuid && _devices[uuid.UUIDString][RNCardConnectReaderLastConnected] != nil;
+}
+
+- (void)recordSeenDevice:(CCCDevice *)device
+{
+    if (!device.uuid) {
+        return;
+    }
+    NSMutableDictionary *entry = [self entryForUUID:device.uuid];
+    if (device.name) {
+        entry[RNCardConnectReaderName] = device.name;
+    }
+    entry[RNCardConnectReaderLastSeen] = @([NSDate date].timeIntervalSince1970);
+    [self save];
+}
+
+- (void)recordConnectedDevice:(NSUUID *)uuid
+{
+    NSMutableDictionary *entry = [self entryForUUID:uuid];
+    NSNumber *now = @([NSDate date].timeIntervalSince1970);
+    entry[RNCardConnectReaderLastSeen] = now;
+    entry[RNCardConnectReaderLastConnected] = now;
+    entry[RNCardConnectReaderFailures] = @0;
+    [self save];
+}
+
+- (void)recordFailedDevice:(NSUUID *)uuid
+{
+    NSMutableDictionary *entry = [self entryForUUID:uuid];
+    entry[RNCardConnectReaderFailures] = @([entry[RNCardConnectReaderFailures] integerValue] + 1);
+    [self save];
+}
+
+- (void)forgetDevice:(NSUUID *)uuid
+{
+    if (!uuid) {
+        return;
+    }
+    [_devices removeObjectForKey:uuid.UUIDString];
+    [self save];
+}
+
+- (NSArray<NSDictionary *> *)knownDevices
+{
+    NSMutableArray<NSDictionary *> *devices = [NSMutableArray new];
+    [_devices enumerateKeysAndObjectsUsingBlock:^(NSString *uuid, NSDictionary *entry, BOOL *stop) {
+        NSMutableDictionary *device = [entry mutableCopy];
+        device[@"uuid"] = uuid;
+        [devices addObject:device];
+    }];
+    return devices;
+}
+
+#pragma mark - Private
+
+- (NSMutableDictionary *)entryForUUID:(NSUUID *)uuid
+{
+    NSMutableDictionary *entry = _devices[uuid.UUIDString];
+    if (!entry) {
+        entry = [NSMutableDictionary new];
+        _devices[uuid.UUIDString] = entry;
+    }
+    return entry;
+}
+
+- (void)save
+{
+    [[NSUserDefaults standardUserDefaults] setObject:_devices forKey:_key];
+}
+
+@end
@@ -0,0 +1,49 @@
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSInteger, RNCardConnectLimiterOutcome) {
+    RNCardConnectLimiterOutcomeSuccess,
+    RNCardConnectLimiterOutcomeFailure,
+    /** The request was cancelled; frees the slot without moving the limit. */
+    RNCardConnectLimiterOutcomeDropped,
+};
+
+typedef NS_ENUM(NSInteger, RNCardConnectRequestPriority) {
+    /** A customer is waiting on the result. */
+    RNCardConnectRequestPriorityInteractive,
+    /** Batch work such as card-on-file migrations. */
+    RNCardConnectRequestPriorityBackground,
+};
+
+/** Called by an operation when its request has finished. */
+typedef void (^RNCardConnectLimiterDone)(RNCardConnectLimiterOutcome outcome);
+typedef void (^RNCardConnectLimitedOperation)(RNCardConnectLimiterDone done);
+
+/**
+ Caps the number of tokenization requests in flight with an AIMD limit.
+ The limit grows by one per window of fast, successful requests and halves
+ when a request fails or takes more than twice the best latency seen so
+ far. Requests over the limit wait in a bounded FIFO queue per priority;
+ freed slots go to interactive requests, except that every fifth one goes
+ to a waiting background request so batches still make progress.
+ Operations start on a global queue of the matching QoS class. Thread safe.
+ */
+@interface RNCardConnectRequestLimiter : NSObject
+
+- (instancetype)initWithMaxQueueLength:(NSUInteger)maxQueueLength;
+
+/**
+ Starts the operation now or queues it. Returns NO without running either
+ block when the queue for that priority is full. cancel runs instead of
+ operation if the request is dropped from the queue by cancelQueued.
+ */
+- (BOOL)enqueue:(RNCardConnectLimitedOperation)operation
+       priority:(RNCardConnectRequestPriority)priority
+         cancel:(dispatch_block_t)cancel;
+
+- (void)cancelQueued;
+
+/** The current limit, in-flight count and queue length, for diagnostics. */
+- (NSDictionary *)stats;
+
+@end
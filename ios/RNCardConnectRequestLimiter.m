@@ -0,0 +1,170 @@
+
+#import "RNCardConnectRequestLimiter.h"
+#import <QuartzCore/QuartzCore.h>
+
+static double const RNCardConnectLimiterMinLimit = 1;
+static double const RNCardConnectLimiterMaxLimit = 32;
+static double const RNCardConnectLimiterInitialLimit = 4;
+// Interactive requests dispatched in a row before a waiting background
+// request gets the next free slot.
+static NSUInteger const RNCardConnectLimiterInteractiveWeight = 4;
+
+@interface RNCardConnectLimiterEntry : NSObject
+
+@property (nonatomic, copy) RNCardConnectLimitedOperation operation;
+@property (nonatomic, copy) dispatch_block_t cancel;
+@property (nonatomic) RNCardConnectRequestPriority priority;
+
+@end
+
+@implementation RNCardConnectLimiterEntry
+@end
+
+@implementation RNCardConnectRequestLimiter
+{
+    NSUInteger _maxQueueLength;
+    NSMutableArray<RNCardConnectLimiterEntry *> *_interactiveQueue;
+    NSMutableArray<RNCardConnectLimiterEntry *> *_backgroundQueue;
+    NSUInteger _interactiveStreak;
+    NSUInteger _inFlight;
+    double _limit;
+    CFTimeInterval _minLatency;
+    CFTimeInterval _lastDecrease;
+}
+
+- (instancetype)initWithMaxQueueLength:(NSUInteger)maxQueueLength
+{
+    if ((self = [super init])) {
+        _maxQueueLength = maxQueueLength;
+        _interactiveQueue = [NSMutableArray new];
+        _backgroundQueue = [NSMutableArray new];
+        _limit = RNCardConnectLimiterInitialLimit;
+    }
+    return self;
+}
+
+- (BOOL)enqueue:(RNCardConnectLimitedOperation)operation
+       priority:(RNCardConnectRequestPriority)priority
+         cancel:(dispatch_block_t)cancel
+{
+    RNCardConnectLimiterEntry *entry = [RNCardConnectLimiterEntry new];
+    entry.operation = operation;
+    entry.cancel = cancel;
+    entry.priority = priority;
+
+    @synchronized (self) {
+        if (_inFlight >= (NSUInteger)_limit) {
+            NSMutableArray<RNCardConnectLimiterEntry *> *queue = [self queueForPriority:priority];
+            if (queue.count >= _maxQueueLength) {
+                return NO;
+            }
+            [queue addObject:entry];
+            return YES;
+        }
+        _inFlight++;
+    }
+    [self start:entry];
+    return YES;
+}
+
+- (void)cancelQueued
+{
+    NSArray<RNCardConnectLimiterEntry *> *cancelled;
+    @synchronized (self) {
+        cancelled = [_interactiveQueue arrayByAddingObjectsFromArray:_backgroundQueue];
+        [_interactiveQueue removeAllObjects];
+        [_backgroundQueue removeAllObjects];
+    }
+    for (RNCardConnectLimiterEntry *entry in cancelled) {
+        entry.cancel();
+    }
+}
+
+- (NSDictionary *)stats
+{
+    @synchronized (self) {
+        return @{
+            @"limit": @((NSUInteger)_limit),
+            @"inFlight": @(_inFlight),
+            @"queued": @(_interactiveQueue.count + _backgroundQueue.count),
+            @"queuedBackground": @(_backgroundQueue.count),
+            @"minLatency": @(_minLatency * 1000.0),
+        };
+    }
+}
+
+#pragma mark - Private
+
+- (NSMutableArray<RNCardConnectLimiterEntry *> *)queueForPriority:(RNCardConnectRequestPriority)priority
+{
+    return priority == RNCardConnectRequestPriorityBackground ? _backgroundQueue : _interactiveQueue;
+}
+
+/** Called with the lock held once a slot is free. */
+- (RNCardConnectLimiterEntry *)dequeue
+{
+    BOOL backgroundTurn = _backgroundQueue.count > 0
+        && (_interactiveQueue.count == 0 || _interactiveStreak >= RNCardConnectLimiterInteractiveWeight);
+    NSMutableArray<RNCardConnectLimiterEntry *> *queue = backgroundTurn ? _backgroundQueue : _interactiveQueue;
+    _interactiveStreak = backgroundTurn ? 0 : _interactiveStreak + 1;
+
+    RNCardConnectLimiterEntry *entry = queue.firstObject;
+    [queue removeObjectAtIndex:0];
+    return entry;
+}
+
+- (void)start:(RNCardConnectLimiterEntry *)entry
+{
+    qos_class_t qos = entry.priority == RNCardConnectRequestPriorityBackground ? QOS_CLASS_UTILITY : QOS_CLASS_USER_INITIATED;
+    dispatch_async(dispatch_get_global_queue(qos, 0), ^{
+        CFTimeInterval start = CACurrentMediaTime();
+        __block BOOL finished = NO;
+        entry.operation(^(RNCardConnectLimiterOutcome outcome) {
+            // Guard against an operation reporting twice.
+            @synchronized (self) {
+                if (finished) {
+                    return;
+                }
+                finished = YES;
+            }
+            [self finishWithLatency:CACurrentMediaTime() - start outcome:outcome];
+        });
+    });
+}
+
+- (void)finishWithLatency:(CFTimeInterval)latency outcome:(RNCardConnectLimiterOutcome)outcome
+{
+    NSMutableArray<RNCardConnectLimiterEntry *> *next = [NSMutableArray new];
+    @synchronized (self) {
+        _inFlight--;
+        BOOL success = outcome == RNCardConnectLimiterOutcomeSuccess;
+        if (success && (_minLatency == 0 || latency < _minLatency)) {
+            _minLatency = latency;
+        }
+
+        CFTimeInterval now = CACurrentMediaTime();
+        BOOL overloaded = !success || latency > _minLatency * 2;
+        if (outcome == RNCardConnectLimiterOutcomeDropped) {
+            // Says nothing about the server.
+        } else if (overloaded) {
+            // Back off at most once per observed latency so one burst of slow
+            // responses does not collapse the limit to the floor.
+            if (now - _lastDecrease > MAX(latency, _minLatency)) {
+                _limit = MAX(RNCardConnectLimiterMinLimit, _limit / 2);
+                _lastDecrease = now;
+            }
+        } else {
+            _limit = MIN(RNCardConnectLimiterMaxLimit, _limit + 1 / _limit);
+        }
+
+        while (_interactiveQueue.count + _backgroundQueue.count > 0 && _inFlight < (NSUInteger)_limit) {
+            [next addObject:[self dequeue]];
+            _inFlight++;
+        }
+    }
+    for (RNCardConnectLimiterEntry *entry in next) {
+        [self start:entry];
+    }
+}
+
+@end
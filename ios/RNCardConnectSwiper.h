@@ -0,0 +1,49 @@
+
+#import <Foundation/Foundation.h>
+#import <CardConnectConsumerSDK/CCCSwiperController.h>
+
+@class RNCardConnectReaderRegistry;
+@class RNCardConnectSwiper;
+
+@protocol RNCardConnectSwiperDelegate <NSObject>
+
+- (void)swiper:(RNCardConnectSwiper *)swiper sendEvent:(NSString *)name body:(NSDictionary *)body;
+
+/** Lets the owner keep one lane from picking up a reader another lane is using. */
+- (BOOL)swiper:(RNCardConnectSwiper *)swiper canUseDevice:(NSUUID *)uuid;
+
+@end
+
+/**
+ Owns one CCCSwiperController and turns its delegate callbacks into bridge
+ events. On connect it goes straight to the registry's preferred reader and
+ only falls back to a discovery scan when that fails.
+ Must be used from the main queue, which is where the SDK calls back.
+ */
+@interface RNCardConnectSwiper : NSObject
+
+- (instancetype)initWithLane:(NSString *)lane
+                        type:(CCCSwiperType)type
+                        mode:(CCCCardReadMode)mode
+                  continuous:(BOOL)continuous
+                    registry:(RNCardConnectReaderRegistry *)registry
+                    delegate:(id<RNCardConnectSwiperDelegate>)delegate;
+
+@property (nonatomic, copy, readonly) NSString *lane;
+
+/** The reader this swiper is connected or connecting to, if any. */
+@property (nonatomic, readonly) NSUUID *deviceUUID;
+
+- (void)connect;
+- (void)connectToDevice:(NSUUID *)uuid;
+
+/**
+ Runs the completion handed over with the last token or error, re-arming the
+ reader. A no-op in continuous mode, where the reader re-arms by itself.
+ */
+- (void)restart;
+
+- (void)cancelTransaction;
+- (void)releaseDevice;
+
+@end
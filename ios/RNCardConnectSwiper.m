@@ -0,0 +1,377 @@
+
+#import "RNCardConnectSwiper.h"
+#import "RNCardConnectReaderRegistry.h"
+#import "RNCardConnectTrace.h"
+#import <CardConnectConsumerSDK/CCCAccount.h>
+#import <QuartzCore/QuartzCore.h>
+
+// How long a direct reconnect to the preferred reader may take before we
+// give up on it and scan.
+static NSTimeInterval const RNCardConnectDirectConnectTimeout = 8.0;
+
+// Reconnect backoff after an unexpected drop: 0.5s, 1s, 2s, 4s, 8s, then stop.
+static NSTimeInterval const RNCardConnectReconnectBaseDelay = 0.5;
+static NSTimeInterval const RNCardConnectReconnectMaxDelay = 8.0;
+static NSUInteger const RNCardConnectReconnectMaxAttempts = 5;
+
+// Configuration progress arrives far faster than JS can render it; forward
+// at most one update per interval, plus the final one.
+static CFTimeInterval const RNCardConnectProgressInterval = 0.1;
+
+static NSString *RNCardConnectConnectionStateName(CCCSwiperConnectionState state)
+{
+    switch (state) {
+        case CCCSwiperConnectionStateDisconnected:
+            return @"disconnected";
+        case CCCSwiperConnectionStateSearching:
+            return @"searching";
+        case CCCSwiperConnectionStateConnecting:
+            return @"connecting";
+        case CCCSwiperConnectionStateConnected:
+            return @"connected";
+        case CCCSwiperConnectionStateConfiguring:
+            return @"configuring";
+    }
+    return @"unknown";
+}
+
+@interface RNCardConnectSwiper () <CCCSwiperControllerDelegate>
+@end
+
+@implementation RNCardConnectSwiper
+{
+    CCCSwiperController *_controller;
+    CCCCardReadMode _mode;
+    RNCardConnectReaderRegistry *_registry;
+    __weak id<RNCardConnectSwiperDelegate> _delegate;
+
+    NSUUID *_connectingUUID;
+    BOOL _direct;
+    BOOL _connected;
+    NSUInteger _attempt;
+    CFTimeInterval _connectStart;
+
+    // Connection state machine, driven by connectionStateHasChanged:.
+    CCCSwiperConnectionState _state;
+    CFTimeInterval _stateEnteredAt;
+    NSUUID *_connectedUUID;
+    BOOL _reconnecting;
+    NSUInteger _reconnectAttempts;
+    void (^_pendingCompletion)(void);
+    BOOL _continuous;
+    NSUInteger _sequence;
+    // Trace start and flow id of the current card read; 0 while tracing is off.
+    uint64_t _cardReadTraceStart;
+    uint64_t _cardReadFlow;
+    CFTimeInterval _lastProgressEventAt;
+}
+
+- (instancetype)initWithLane:(NSString *)lane
+                        type:(CCCSwiperType)type
+                        mode:(CCCCardReadMode)mode
+                  continuous:(BOOL)continuous
+                    registry:(RNCardConnectReaderRegistry *)registry
+                    delegate:(id<RNCardConnectSwiperDelegate>)delegate
+{
+    if ((self = [super init])) {
+        _lane = [lane copy];
+        _continuous = continuous;
+        _controller = [[CCCSwiperController alloc] initWithDelegate:self swiper:type loggingEnabled:NO];
+        _mode = mode;
+        _registry = registry;
+        _delegate = delegate;
+        _state = CCCSwiperConnectionStateDisconnected;
+        _stateEnteredAt = CACurrentMediaTime();
+    }
+    return self;
+}
+
+- (NSUUID *)deviceUUID
+{
+    return _connectingUUID ?: _connectedUUID;
+}
+
+- (void)connect
+{
+    [self stopReconnecting];
+    _connectStart = CACurrentMediaTime();
+    NSUUID *preferred = [_registry preferredDeviceUUID];
+    if (preferred && [_delegate swiper:self canUseDevice:preferred]) {
+        [self connectToDevice:preferred direct:YES];
+    } else {
+        [self scan];
+    }
+}
+
+- (void)connectToDevice:(NSUUID *)uuid
+{
+    [self stopReconnecting];
+    if (_connectStart == 0) {
+        _connectStart = CACurrentMediaTime();
+    }
+    [self connectToDevice:uuid direct:NO];
+}
+
+- (void)restart
+{
+    void (^completion)(void) = _pendingCompletion;
+    _pendingCompletion = nil;
+    if (completion) {
+        completion();
+    }
+}
+
+- (void)cancelTransaction
+{
+    [_controller cancelTransaction];
+}
+
+- (void)releaseDevice
+{
+    [self stopReconnecting];
+    _pendingCompletion = nil;
+    _connectingUUID = nil;
+    _connectedUUID = nil;
+    [_controller releaseDevice];
+    _controller = nil;
+}
+
+#pragma mark - Connection
+
+- (void)connectToDevice:(NSUUID *)uuid direct:(BOOL)direct
+{
+    _connectingUUID = uuid;
+    _direct = direct;
+    _connected = NO;
+    NSUInteger attempt = ++_attempt;
+    [_controller connectToDevice:uuid mode:_mode];
+
+    if (direct) {
+        __weak RNCardConnectSwiper *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(RNCardConnectDirectConnectTimeout * NSEC_PER_SEC)),
+                       dispatch_get_main_queue(), ^{
+            [weakSelf directConnectTimedOut:attempt];
+        });
+    }
+}
+
+- (void)directConnectTimedOut:(NSUInteger)attempt
+{
+    if (attempt != _attempt || _connected || !_direct) {
+        return;
+    }
+    [self directConnectFailed];
+}
+
+- (void)directConnectFailed
+{
+    [_registry recordFailedDevice:_connectingUUID];
+    _connectingUUID = nil;
+    _direct = NO;
+    [_controller cancelFindDevices];
+    [self scan];
+}
+
+- (void)scheduleReconnect
+{
+    if (!_controller || !_connectedUUID) {
+        return;
+    }
+    if (_reconnectAttempts >= RNCardConnectReconnectMaxAttempts) {
+        [self sendEvent:@"swiperReconnectFailed" body:@{
+            @"uuid": _connectedUUID.UUIDString,
+            @"attempts": @(_reconnectAttempts),
+        }];
+        [self stopReconnecting];
+        return;
+    }
+
+    NSTimeInterval delay = MIN(RNCardConnectReconnectBaseDelay * (double)(1 << _reconnectAttempts),
+                               RNCardConnectReconnectMaxDelay);
+    _reconnecting = YES;
+    _reconnectAttempts++;
+    if (_connectStart == 0) {
+        _connectStart = CACurrentMediaTime();
+    }
+    [self sendEvent:@"swiperReconnecting" body:@{
+        @"uuid": _connectedUUID.UUIDString,
+        @"attempt": @(_reconnectAttempts),
+        @"delay": @(delay * 1000.0),
+    }];
+
+    NSUInteger attempt = ++_attempt;
+    __weak RNCardConnectSwiper *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [weakSelf reconnect:attempt];
+    });
+}
+
+- (void)reconnect:(NSUInteger)attempt
+{
+    // Anything that touched the connection since the timer was set wins.
+    if (attempt != _attempt || !_reconnecting || !_controller) {
+        return;
+    }
+    [self connectToDevice:_connectedUUID direct:NO];
+}
+
+- (void)stopReconnecting
+{
+    _reconnecting = NO;
+    _reconnectAttempts = 0;
+}
+
+- (void)scan
+{
+    _connectingUUID = nil;
+    _direct = NO;
+    [_controller findDevices];
+}
+
+#pragma mark - CCCSwiperControllerDelegate
+
+- (void)swiper:(CCCSwiperController *)swiper foundDevices:(NSArray *)devices
+{
+    NSMutableArray<CCCDevice *> *available = [NSMutableArray arrayWithCapacity:devices.count];
+    for (CCCDevice *device in devices) {
+        if ([_delegate swiper:self canUseDevice:device.uuid]) {
+            [available addObject:device];
+        }
+    }
+    NSArray<CCCDevice *> *ranked = [_registry rankDevices:available];
+    NSMutableArray<NSDictionary *> *body = [NSMutableArray arrayWithCapacity:ranked.count];
+    for (CCCDevice *device in ranked) {
+        [_registry recordSeenDevice:device];
+        [body addObject:@{
+            @"uuid": device.uuid.UUIDString ?: @"",
+            @"name": device.name ?: @"",
+            @"known": @([_registry isKnownDevice:device.uuid]),
+        }];
+    }
+    [self sendEvent:@"swiperFoundDevices" body:@{@"devices": body}];
+
+    CCCDevice *best = ranked.firstObject;
+    if (!_connectingUUID && best && [_registry isKnownDevice:best.uuid]) {
+        [self connectToDevice:best.uuid direct:NO];
+    }
+}
+
+- (void)swiper:(CCCSwiperController *)swiper displayMessage:(NSString *)message canCancel:(BOOL)cancelable
+{
+    RNCardConnectTraceInstant("displayMessage", _cardReadFlow);
+    [self sendEvent:@"swiperDisplayMessage" body:@{@"message": message ?: @"", @"canCancel": @(cancelable)}];
+}
+
+- (void)swiper:(CCCSwiper *)swiper connectionStateHasChanged:(CCCSwiperConnectionState)state
+{
+    CFTimeInterval now = CACurrentMediaTime();
+    CCCSwiperConnectionState previous = _state;
+    [self sendEvent:@"swiperConnectionStateChanged" body:@{
+        @"state": RNCardConnectConnectionStateName(state),
+        @"previousState": RNCardConnectConnectionStateName(previous),
+        @"elapsed": @((now - _stateEnteredAt) * 1000.0),
+    }];
+    _state = state;
+    _stateEnteredAt = now;
+
+    if (state == CCCSwiperConnectionStateConnected && !_connected) {
+        _connected = YES;
+        if (_connectingUUID) {
+            [_registry recordConnectedDevice:_connectingUUID];
+            _connectedUUID = _connectingUUID;
+        }
+        [self sendEvent:@"swiperReady" body:@{
+            @"uuid": _connectingUUID.UUIDString ?: [NSNull null],
+            @"direct": @(_direct),
+            @"reconnected": @(_reconnecting),
+            @"timeToReady": @((now - _connectStart) * 1000.0),
+        }];
+        _connectStart = 0;
+        [self stopReconnecting];
+    } else if (state == CCCSwiperConnectionStateDisconnected) {
+        BOOL wasConnected = _connected;
+        _connected = NO;
+        if (wasConnected || _reconnecting) {
+            // Dropped mid-shift, or a reconnect attempt did not take.
+            _pendingCompletion = nil;
+            [self scheduleReconnect];
+        } else if (_direct && _connectingUUID) {
+            [self directConnectFailed];
+        }
+    }
+}
+
+- (void)swiperDidStartCardRead:(CCCSwiper *)swiper
+{
+    _sequence++;
+    _cardReadTraceStart = RNCardConnectTraceBegin();
+    _cardReadFlow = _cardReadTraceStart ? RNCardConnectTraceNextFlow() : 0;
+    RNCardConnectTraceInstant("swiperDidStartCardRead", _cardReadFlow);
+    [self sendEvent:@"swiperCardReadStarted" body:@{@"sequence": @(_sequence)}];
+}
+
+- (void)swiper:(CCCSwiper *)swiper didGenerateTokenWithAccount:(CCCAccount *)account completion:(void (^)(void))completion
+{
+    // Card read plus the SDK's own tokenization request.
+    RNCardConnectTraceEnd("cardReadToToken", _cardReadTraceStart, _cardReadFlow);
+    uint64_t eventStart = RNCardConnectTraceBegin();
+    [self sendEvent:@"swiperToken" body:@{
+        @"sequence": @(_sequence),
+        @"token": account.token ?: [NSNull null],
+        @"last4": account.last4 ?: [NSNull null],
+        @"accountType": account.accountType ?: [NSNull null],
+        @"receiptData": account.receiptData ?: [NSNull null],
+    }];
+    RNCardConnectTraceEnd("sendTokenEvent", eventStart, _cardReadFlow);
+    [self finishCardRead:completion];
+}
+
+- (void)swiper:(CCCSwiper *)swiper didFailWithError:(NSError *)error completion:(void (^)(void))completion
+{
+    RNCardConnectTraceEnd("cardReadToError", _cardReadTraceStart, _cardReadFlow);
+    [self sendEvent:@"swiperError" body:@{
+        @"sequence": @(_sequence),
+        @"code": @(error.code),
+        @"message": error.localizedDescription ?: @"",
+    }];
+    [self finishCardRead:completion];
+}
+
+- (void)swiper:(CCCSwiper *)swiper batteryLevelStatusHasChanged:(CCCSwiperBatteryStatus)status
+{
+    [self sendEvent:@"swiperBatteryStatus" body:@{
+        @"status": status == CCCSwiperBatteryStatusCritical ? @"critical" : @"low",
+    }];
+}
+
+- (void)swiper:(CCCSwiperController *)swiper configurationProgress:(float)progress
+{
+    CFTimeInterval now = CACurrentMediaTime();
+    if (progress < 1.0f && now - _lastProgressEventAt < RNCardConnectProgressInterval) {
+        return;
+    }
+    _lastProgressEventAt = progress < 1.0f ? now : 0;
+    [self sendEvent:@"swiperConfigurationProgress" body:@{@"progress": @(progress)}];
+}
+
+#pragma mark - Private
+
+- (void)finishCardRead:(void (^)(void))completion
+{
+    RNCardConnectTraceInstant("cardReadFinished", _cardReadFlow);
+    _cardReadFlow = 0;
+    if (_continuous) {
+        // Re-arm right away; the result is already on its way to JS and the
+        // sequence number keeps it matched to its card read.
+        completion();
+    } else {
+        _pendingCompletion = [completion copy];
+    }
+}
+
+- (void)sendEvent:(NSString *)name body:(NSDictionary *)body
+{
+    [_delegate swiper:self sendEvent:name body:body];
+}
+
+@end
@@ -0,0 +1,30 @@
+#import <Foundation/Foundation.h>
+
+/** Reports one row's result, or nil when the row was cancelled and should be retried on resume. */
+typedef void (^RNCardConnectBatchRowDone)(NSDictionary *result);
+typedef void (^RNCardConnectBatchSubmit)(NSUInteger index, RNCardConnectBatchRowDone done);
+
+/**
+ Feeds a range of rows through a submit block with a bounded number of rows
+ outstanding, so a large batch never overflows the request queue. Rows may
+ finish in any order; the checkpoint is the index of the first row that has
+ not finished, which is where an interrupted batch resumes. A cancelled row
+ stops the batch from submitting further rows.
+ */
+@interface RNCardConnectTokenBatch : NSObject
+
+- (instancetype)initWithRange:(NSRange)range
+                       window:(NSUInteger)window
+                       submit:(RNCardConnectBatchSubmit)submit;
+
+/** Called once per finished row with its result and the checkpoint after it. */
+@property (nonatomic, copy) void (^rowHandler)(NSUInteger index, NSDictionary *result, NSUInteger checkpoint);
+
+- (void)runWithCompletion:(void (^)(NSUInteger succeeded, NSUInteger failed, NSUInteger checkpoint))completion;
+
+/** Stops submitting rows; the completion runs once the outstanding ones finish. */
+- (void)stop;
+
+@property (nonatomic, readonly, getter=isStopped) BOOL stopped;
+
+@end
@@ -0,0 +1,139 @@
+#import "RNCardConnectTokenBatch.h"
+
+@implementation RNCardConnectTokenBatch
+{
+    NSRange _range;
+    NSUInteger _window;
+    RNCardConnectBatchSubmit _submit;
+    void (^_completion)(NSUInteger, NSUInteger, NSUInteger);
+
+    NSUInteger _next;
+    NSUInteger _outstanding;
+    NSUInteger _succeeded;
+    NSUInteger _failed;
+    NSUInteger _checkpoint;
+    // Finished rows past the checkpoint, waiting for the rows before them.
+    NSMutableIndexSet *_finished;
+    BOOL _pumping;
+    BOOL _stopped;
+    BOOL _completed;
+}
+
+- (instancetype)initWithRange:(NSRange)range
+                       window:(NSUInteger)window
+                       submit:(RNCardConnectBatchSubmit)submit
+{
+    if ((self = [super init])) {
+        _range = range;
+        _window = MAX(window, 1);
+        _submit = [submit copy];
+        _next = range.location;
+        _checkpoint = range.location;
+        _finished = [NSMutableIndexSet new];
+    }
+    return self;
+}
+
+- (void)runWithCompletion:(void (^)(NSUInteger, NSUInteger, NSUInteger))completion
+{
+    _completion = [completion copy];
+    [self pump];
+}
+
+- (void)stop
+{
+    @synchronized (self) {
+        _stopped = YES;
+    }
+    [self completeIfDone];
+}
+
+- (BOOL)isStopped
+{
+    @synchronized (self) {
+        return _stopped;
+    }
+}
+
+#pragma mark - Private
+
+- (void)pump
+{
+    @synchronized (self) {
+        // Rows that fail synchronously finish inside the submit call below;
+        // the loop already running picks up their freed slots instead of
+        // recursing once per row.
+        if (_pumping) {
+            return;
+        }
+        _pumping = YES;
+    }
+
+    while (YES) {
+        NSUInteger index;
+        @synchronized (self) {
+            if (_stopped || _next >= NSMaxRange(_range) || _outstanding >= _window) {
+                _pumping = NO;
+                break;
+            }
+            index = _next++;
+            _outstanding++;
+        }
+        _submit(index, ^(NSDictionary *result) {
+            [self finishRow:index result:result];
+        });
+    }
+    [self completeIfDone];
+}
+
+- (void)finishRow:(NSUInteger)index result:(NSDictionary *)result
+{
+    NSUInteger checkpoint;
+    @synchronized (self) {
+        _outstanding--;
+        if (!result) {
+            _stopped = YES;
+        } else {
+            if (result[@"token"]) {
+                _succeeded++;
+            } else {
+                _failed++;
+            }
+            [_finished addIndex:index];
+            while ([_finished containsIndex:_checkpoint]) {
+                [_finished removeIndex:_checkpoint];
+                _checkpoint++;
+            }
+        }
+        checkpoint = _checkpoint;
+    }
+
+    if (result && _rowHandler) {
+        _rowHandler(index, result, checkpoint);
+    }
+    [self pump];
+}
+
+- (void)completeIfDone
+{
+    void (^completion)(NSUInteger, NSUInteger, NSUInteger);
+    NSUInteger succeeded, failed, checkpoint;
+    @synchronized (self) {
+        BOOL drained = _stopped || _next >= NSMaxRange(_range);
+        if (_completed || _pumping || _outstanding > 0 || !drained) {
+            return;
+        }
+        _completed = YES;
+        completion = _completion;
+        // The completion usually captures the batch itself.
+        _completion = nil;
+        succeeded = _succeeded;
+        failed = _failed;
+        checkpoint = _checkpoint;
+    }
+    if (completion) {
+        completion(succeeded, failed, checkpoint);
+    }
+}
+
+@end
@@ -0,0 +1,22 @@
+
+#import <Foundation/Foundation.h>
+
+/**
+ An in-memory cache of card tokens for repeat submissions within a session.
+ Entries are keyed by an HMAC-SHA256 of the card data under a random key that
+ only lives in memory, so the table never holds card data itself. Clearing the
+ cache wipes that key and starts a new one. Thread safe.
+ */
+@interface RNCardConnectTokenCache : NSObject
+
+@property (atomic, assign) NSTimeInterval ttl;
+
+/** The cache key for a card. Compute it up front so callers need not hold on to the card data. */
+- (NSData *)keyForCardNumber:(NSString *)cardNumber expirationDate:(NSString *)expirationDate CVV:(NSString *)CVV;
+
+- (NSString *)tokenForKey:(NSData *)key;
+- (void)setToken:(NSString *)token forKey:(NSData *)key;
+
+- (void)clear;
+
+@end
@@ -0,0 +1,109 @@
+
+#import "RNCardConnectTokenCache.h"
+#import <CommonCrypto/CommonHMAC.h>
+#import <Security/Security.h>
+
+@interface RNCardConnectTokenCacheEntry : NSObject
+
+@property (nonatomic, copy) NSString *token;
+@property (nonatomic, strong) NSDate *expiresAt;
+
+@end
+
+@implementation RNCardConnectTokenCacheEntry
+@end
+
+@implementation RNCardConnectTokenCache
+{
+    uint8_t _key[CC_SHA256_DIGEST_LENGTH];
+    NSMutableDictionary<NSData *, RNCardConnectTokenCacheEntry *> *_entries;
+}
+
+- (instancetype)init
+{
+    if ((self = [super init])) {
+        _entries = [NSMutableDictionary new];
+        [self rotateKey];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    memset_s(_key, sizeof(_key), 0, sizeof(_key));
+}
+
+- (NSData *)keyForCardNumber:(NSString *)cardNumber expirationDate:(NSString *)expirationDate CVV:(NSString *)CVV
+{
+    @synchronized (self) {
+        CCHmacContext context;
+        CCHmacInit(&context, kCCHmacAlgSHA256, _key, sizeof(_key));
+        // Hashing each field's terminating NUL keeps ("41", "11") and
+        // ("411", "1") from colliding.
+        for (NSString *field in @[cardNumber ?: @"", expirationDate ?: @"", CVV ?: @""]) {
+            const char *bytes = field.UTF8String;
+            CCHmacUpdate(&context, bytes, strlen(bytes) + 1);
+        }
+        uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+        CCHmacFinal(&context, digest);
+        memset_s(&context, sizeof(context), 0, sizeof(context));
+        return [NSData dataWithBytes:digest length:sizeof(digest)];
+    }
+}
+
+- (NSString *)tokenForKey:(NSData *)key
+{
+    @synchronized (self) {
+        RNCardConnectTokenCacheEntry *entry = _entries[key];
+        if (entry && [entry.expiresAt timeIntervalSinceNow] <= 0) {
+            [_entries removeObjectForKey:key];
+            return nil;
+        }
+        return entry.token;
+    }
+}
+
+- (void)setToken:(NSString *)token forKey:(NSData *)key
+{
+    NSTimeInterval ttl = self.ttl;
+    if (!token || !key || ttl <= 0) {
+        return;
+    }
+    RNCardConnectTokenCacheEntry *entry = [RNCardConnectTokenCacheEntry new];
+    entry.token = token;
+    entry.expiresAt = [NSDate dateWithTimeIntervalSinceNow:ttl];
+    @synchronized (self) {
+        [self removeExpiredEntries];
+        _entries[key] = entry;
+    }
+}
+
+- (void)clear
+{
+    @synchronized (self) {
+        [_entries removeAllObjects];
+        [self rotateKey];
+    }
+}
+
+#pragma mark - Private
+
+- (void)rotateKey
+{
+    if (SecRandomCopyBytes(kSecRandomDefault, sizeof(_key), _key) != errSecSuccess) {
+        arc4random_buf(_key, sizeof(_key));
+    }
+}
+
+// Entries stored under a key from before the last clear can never be looked
+// up again; they are dropped here once they expire.
+- (void)removeExpiredEntries
+{
+    NSDate *now = [NSDate date];
+    NSArray<NSData *> *expired = [_entries keysOfEntriesPassingTest:^BOOL(NSData *key, RNCardConnectTokenCacheEntry *entry, BOOL *stop) {
+        return [entry.expiresAt compare:now] != NSOrderedDescending;
+    }].allObjects;
+    [_entries removeObjectsForKeys:expired];
+}
+
+@end
@@ -0,0 +1,47 @@
+#import <Foundation/Foundation.h>
+#import <stdatomic.h>
+
+/**
+ Opt-in span tracing exported as Chrome trace JSON (chrome://tracing,
+ ui.perfetto.dev). Every thread records into its own fixed-size buffer, so
+ recording takes no locks; while tracing is off each call is a single
+ relaxed atomic load. Names must be string literals: only the pointer is
+ stored. Spans that cross threads are recorded as complete events when they
+ end, from the start time returned by RNCardConnectTraceBegin. Spans that
+ share a flow id are linked with flow arrows in the export.
+ */
+
+extern atomic_bool RNCardConnectTraceActive;
+
+uint64_t RNCardConnectTraceNow(void);
+/** A new flow id for one transaction, unique across token requests and lanes; never 0. */
+uint64_t RNCardConnectTraceNextFlow(void);
+void RNCardConnectTraceRecord(const char *name, char phase, uint64_t start, uint64_t end, uint64_t flow);
+
+/** Start time for a span, or 0 while tracing is off. */
+static inline uint64_t RNCardConnectTraceBegin(void)
+{
+    return atomic_load_explicit(&RNCardConnectTraceActive, memory_order_relaxed) ? RNCardConnectTraceNow() : 0;
+}
+
+/** Records a span from a RNCardConnectTraceBegin result; flow ties the spans of one transaction together. */
+static inline void RNCardConnectTraceEnd(const char *name, uint64_t start, uint64_t flow)
+{
+    if (start && atomic_load_explicit(&RNCardConnectTraceActive, memory_order_relaxed)) {
+        RNCardConnectTraceRecord(name, 'X', start, RNCardConnectTraceNow(), flow);
+    }
+}
+
+static inline void RNCardConnectTraceInstant(const char *name, uint64_t flow)
+{
+    if (atomic_load_explicit(&RNCardConnectTraceActive, memory_order_relaxed)) {
+        uint64_t now = RNCardConnectTraceNow();
+        RNCardConnectTraceRecord(name, 'i', now, now, flow);
+    }
+}
+
+/** Starting clears whatever the previous session recorded. */
+void RNCardConnectTraceSetEnabled(BOOL enabled);
+
+/** The recorded events as a Chrome trace object, plus how many were dropped on full buffers. */
+NSDictionary *RNCardConnectTraceExport(NSUInteger *dropped);
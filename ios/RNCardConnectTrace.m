@@ -0,0 +1,202 @@
+#import "RNCardConnectTrace.h"
+#import <pthread.h>
+#import <time.h>
+#import <unistd.h>
+
+static size_t const RNCardConnectTraceCapacity = 2048;
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+    uint64_t flow;
+    char phase;
+} RNCardConnectTraceEvent;
+
+typedef struct RNCardConnectTraceBuffer {
+    struct RNCardConnectTraceBuffer *next;
+    // Cleared by the thread-exit destructor so another thread can adopt it.
+    atomic_bool inUse;
+    uint64_t threadID;
+    char threadName[64];
+    // Buffers left over from an earlier session reset themselves on their
+    // owner's next record, so stopping and starting never races a writer.
+    _Atomic uint32_t generation;
+    _Atomic size_t count;
+    _Atomic size_t dropped;
+    RNCardConnectTraceEvent events[RNCardConnectTraceCapacity];
+} RNCardConnectTraceBuffer;
+
+atomic_bool RNCardConnectTraceActive = false;
+
+static _Atomic uint32_t RNCardConnectTraceGeneration = 0;
+static _Atomic uint64_t RNCardConnectTraceLastFlow = 0;
+static _Atomic(RNCardConnectTraceBuffer *) RNCardConnectTraceBuffers = NULL;
+static pthread_key_t RNCardConnectTraceKey;
+
+static void RNCardConnectTraceReleaseBuffer(void *buffer)
+{
+    atomic_store(&((RNCardConnectTraceBuffer *)buffer)->inUse, false);
+}
+
+static RNCardConnectTraceBuffer *RNCardConnectTraceThreadBuffer(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&RNCardConnectTraceKey, RNCardConnectTraceReleaseBuffer);
+    });
+
+    RNCardConnectTraceBuffer *buffer = pthread_getspecific(RNCardConnectTraceKey);
+    if (buffer) {
+        return buffer;
+    }
+
+    // First event on this thread: adopt a buffer whose thread has exited,
+    // or push a new one. Buffers are never unlinked, so the list can be
+    // walked without a lock.
+    for (buffer = atomic_load(&RNCardConnectTraceBuffers); buffer; buffer = buffer->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&buffer->inUse, &expected, true)) {
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = calloc(1, sizeof(RNCardConnectTraceBuffer));
+        atomic_init(&buffer->inUse, true);
+        buffer->next = atomic_load(&RNCardConnectTraceBuffers);
+        while (!atomic_compare_exchange_weak(&RNCardConnectTraceBuffers, &buffer->next, buffer)) {
+        }
+    }
+
+    pthread_threadid_np(NULL, &buffer->threadID);
+    if (pthread_main_np()) {
+        strlcpy(buffer->threadName, "main", sizeof(buffer->threadName));
+    } else {
+        pthread_getname_np(pthread_self(), buffer->threadName, sizeof(buffer->threadName));
+    }
+    // Forces a reset on the first record so a previous owner's events are dropped.
+    atomic_store_explicit(&buffer->generation, UINT32_MAX, memory_order_relaxed);
+    pthread_setspecific(RNCardConnectTraceKey, buffer);
+    return buffer;
+}
+
+uint64_t RNCardConnectTraceNow(void)
+{
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+uint64_t RNCardConnectTraceNextFlow(void)
+{
+    return atomic_fetch_add_explicit(&RNCardConnectTraceLastFlow, 1, memory_order_relaxed) + 1;
+}
+
+void RNCardConnectTraceRecord(const char *name, char phase, uint64_t start, uint64_t end, uint64_t flow)
+{
+    RNCardConnectTraceBuffer *buffer = RNCardConnectTraceThreadBuffer();
+    uint32_t generation = atomic_load_explicit(&RNCardConnectTraceGeneration, memory_order_acquire);
+    if (atomic_load_explicit(&buffer->generation, memory_order_relaxed) != generation) {
+        atomic_store_explicit(&buffer->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&buffer->dropped, 0, memory_order_relaxed);
+        atomic_store_explicit(&buffer->generation, generation, memory_order_release);
+    }
+
+    size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    if (count == RNCardConnectTraceCapacity) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    buffer->events[count] = (RNCardConnectTraceEvent){name, start, end, flow, phase};
+    // Publishes the event to RNCardConnectTraceExport.
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_release);
+}
+
+void RNCardConnectTraceSetEnabled(BOOL enabled)
+{
+    if (enabled) {
+        atomic_fetch_add_explicit(&RNCardConnectTraceGeneration, 1, memory_order_release);
+    }
+    atomic_store(&RNCardConnectTraceActive, enabled);
+}
+
+NSDictionary *RNCardConnectTraceExport(NSUInteger *dropped)
+{
+    uint32_t generation = atomic_load_explicit(&RNCardConnectTraceGeneration, memory_order_acquire);
+    NSMutableArray<NSDictionary *> *events = [NSMutableArray new];
+    // Start, end and thread of every span with a flow id, keyed by the id.
+    NSMutableDictionary<NSNumber *, NSMutableArray<NSArray<NSNumber *> *> *> *flows = [NSMutableDictionary new];
+    NSUInteger droppedEvents = 0;
+    int pid = getpid();
+
+    for (RNCardConnectTraceBuffer *buffer = atomic_load(&RNCardConnectTraceBuffers); buffer; buffer = buffer->next) {
+        if (atomic_load_explicit(&buffer->generation, memory_order_acquire) != generation) {
+            continue;
+        }
+        size_t count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+        if (count == 0) {
+            continue;
+        }
+        droppedEvents += atomic_load_explicit(&buffer->dropped, memory_order_relaxed);
+
+        NSNumber *tid = @(buffer->threadID);
+        [events addObject:@{
+            @"name": @"thread_name",
+            @"ph": @"M",
+            @"pid": @(pid),
+            @"tid": tid,
+            @"args": @{@"name": buffer->threadName[0] ? @(buffer->threadName) : tid.stringValue},
+        }];
+        for (size_t i = 0; i < count; i++) {
+            RNCardConnectTraceEvent event = buffer->events[i];
+            NSMutableDictionary *entry = [@{
+                @"name": @(event.name),
+                @"cat": @"cardconnect",
+                @"ph": [NSString stringWithFormat:@"%c", event.phase],
+                @"ts": @(event.start / 1000.0),
+                @"pid": @(pid),
+                @"tid": tid,
+                @"args": @{@"flow": @(event.flow)},
+            } mutableCopy];
+            if (event.phase == 'X') {
+                entry[@"dur"] = @((event.end - event.start) / 1000.0);
+                if (event.flow) {
+                    NSMutableArray *spans = flows[@(event.flow)] ?: (flows[@(event.flow)] = [NSMutableArray new]);
+                    [spans addObject:@[@(event.start), @(event.end), tid]];
+                }
+            } else {
+                entry[@"s"] = @"t";
+            }
+            [events addObject:entry];
+        }
+    }
+
+    // Flow events bound to the start of each span ("bp": "e" binds to the
+    // enclosing slice) draw arrows from span to span in start order; of two
+    // spans starting together, the outer one comes first.
+    [flows enumerateKeysAndObjectsUsingBlock:^(NSNumber *flow, NSMutableArray<NSArray<NSNumber *> *> *spans, BOOL *stop) {
+        if (spans.count < 2) {
+            return;
+        }
+        [spans sortUsingComparator:^NSComparisonResult(NSArray<NSNumber *> *a, NSArray<NSNumber *> *b) {
+            NSComparisonResult order = [a[0] compare:b[0]];
+            return order != NSOrderedSame ? order : [b[1] compare:a[1]];
+        }];
+        for (NSUInteger i = 0; i < spans.count; i++) {
+            NSString *phase = i == 0 ? @"s" : i + 1 == spans.count ? @"f" : @"t";
+            [events addObject:@{
+                @"name": @"flow",
+                @"cat": @"cardconnect",
+                @"ph": phase,
+                @"id": flow,
+                @"bp": @"e",
+                @"ts": @(spans[i][0].unsignedLongLongValue / 1000.0),
+                @"pid": @(pid),
+                @"tid": spans[i][2],
+            }];
+        }
+    }];
+
+    if (dropped) {
+        *dropped = droppedEvents;
+    }
+    return @{@"traceEvents": events, @"displayTimeUnit": @"ms"};
+}